@@ -0,0 +1,14 @@
+#!/bin/bash
+
+set -e
+
+# Usage: ./bench.sh [gemm|det|strassen|elementwise|io|fixed|batch|solve|gemv|chain|cow|pool|small|structured|pow] [bench arguments...]
+# Extra compiler flags come from CXXFLAGS, e.g. CXXFLAGS=-DTASK_MATRIX_INLINE_ELEMENTS=0.
+BENCH=${1:-gemm}
+shift || true
+SOURCES="src/matrix.cpp src/buffer_pool.cpp src/gemm.cpp src/thread_pool.cpp src/lu.cpp src/cholesky.cpp src/qr.cpp src/strassen.cpp src/matrix_view.cpp src/simd.cpp src/sparse_matrix.cpp src/matrix_io.cpp src/matrix_batch.cpp src/matrix_chain.cpp src/structured_matrix.cpp src/matrix_stats.cpp"
+
+g++ -std=c++17 -O3 -march=native $CXXFLAGS -I./ bench/${BENCH}_bench.cpp $SOURCES -pthread -o ${BENCH}_bench
+./${BENCH}_bench "$@"
+
+rm ${BENCH}_bench
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+#include "src/fixed_matrix.h"
+#include "src/matrix_batch.h"
+
+using task::FixedMatrix;
+using task::Matrix;
+using task::MatrixBatch;
+
+template<size_t N>
+std::vector<FixedMatrix<N, N>> RandomMatrices(size_t count) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  std::vector<FixedMatrix<N, N>> temp(count);
+  for (auto &matrix : temp)
+    for (size_t row = 0; row < N; ++row)
+      for (size_t col = 0; col < N; ++col)
+        matrix[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Seconds(F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// Reports millions of matrices per second and the GB/s of matrix data touched by one pass.
+void Report(const char *type, const char *op, size_t count, size_t bytes, double seconds) {
+  std::cout << type << '\t' << op << '\t' << count / seconds * 1e-6 << '\t' << bytes / seconds * 1e-9
+            << std::endl;
+}
+
+template<size_t N>
+void Run(size_t count) {
+  auto fixed = RandomMatrices<N>(count);
+  std::vector<Matrix> dynamic;
+  MatrixBatch a(count, N, N), b(count, N, N);
+  for (size_t i = 0; i < count; ++i) {
+    dynamic.push_back(Matrix(fixed[i]));
+    a.setMatrix(i, dynamic[i]);
+    b.setMatrix(i, Matrix(fixed[(i + 1) % count]));
+  }
+  size_t det_bytes = count * N * N * sizeof(double), product_bytes = 3 * det_bytes;
+  volatile double sink = 0.;
+
+  std::cout << N << 'x' << N << std::endl;
+  Report("Matrix", "det", count, det_bytes, Seconds([&] {
+           for (size_t i = 0; i < count; ++i)
+             sink = sink + dynamic[i].det();
+         }));
+  Report("Fixed", "det", count, det_bytes, Seconds([&] {
+           for (size_t i = 0; i < count; ++i)
+             sink = sink + fixed[i].det();
+         }));
+  Report("Batch", "det", count, det_bytes, Seconds([&] { sink = sink + a.det()[0]; }));
+  Report("Matrix", "product", count, product_bytes, Seconds([&] {
+           for (size_t i = 0; i < count; ++i)
+             sink = sink + Matrix(dynamic[i] * dynamic[(i + 1) % count])[0][0];
+         }));
+  Report("Fixed", "product", count, product_bytes, Seconds([&] {
+           for (size_t i = 0; i < count; ++i)
+             sink = sink + (fixed[i] * fixed[(i + 1) % count])[0][0];
+         }));
+  Report("Batch", "product", count, product_bytes, Seconds([&] { sink = sink + (a * b).get(0, 0, 0); }));
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  std::cout << "throughput for " << count << " matrices" << std::endl;
+  std::cout << "type\top\tM/s\tGB/s" << std::endl;
+  Run<3>(count);
+  Run<4>(count);
+}
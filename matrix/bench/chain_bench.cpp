@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+#include "src/matrix_chain.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Seconds(F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void Run(const std::vector<size_t> &dims) {
+  std::vector<Matrix> operands;
+  for (size_t i = 0; i + 1 < dims.size(); ++i)
+    operands.push_back(RandomMatrix(dims[i], dims[i + 1]));
+
+  task::MatrixChain chain(operands[0]);
+  for (size_t i = 1; i < operands.size(); ++i)
+    chain *= operands[i];
+  task::ChainPlan plan = chain.plan();
+  volatile double sink = 0.;
+
+  double left_to_right = Seconds([&] {
+    Matrix product = operands[0];
+    for (size_t i = 1; i < operands.size(); ++i)
+      product = product * operands[i];
+    sink = sink + product[0][0];
+  });
+  double planned = Seconds([&] { sink = sink + chain.evaluate()[0][0]; });
+
+  for (size_t i = 0; i < dims.size(); ++i)
+    std::cout << (i ? "x" : "") << dims[i];
+  std::cout << '\t' << plan.toString() << '\t' << plan.left_to_right_cost << '\t' << plan.cost << '\t'
+            << left_to_right << '\t' << planned << std::endl;
+}
+
+int main() {
+  std::cout << "shapes\tplan\tleft-to-right multiply-adds\tplanned multiply-adds\t"
+            << "left-to-right seconds\tplanned seconds" << std::endl;
+  Run({2000, 10, 2000, 10, 2000, 1});
+  Run({30, 35, 15, 5, 10, 20, 25});
+  Run({1000, 1000, 1000, 1000, 1});
+  Run({10, 1000, 1000, 1000, 1000});
+}
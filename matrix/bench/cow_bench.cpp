@@ -0,0 +1,55 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+double ReadByValue(Matrix copy) { return copy.trace(); }
+
+template<class F>
+double Microseconds(size_t repeats, F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repeats * 1e6;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const size_t sizes[] = {10, 100, 500, 1000, 2000};
+
+  std::cout << "microseconds per copy" << std::endl;
+  std::cout << "size\tdeep copy\tshared copy\tshared copy, first write" << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomMatrix(n, n);
+    size_t repeats = std::max<size_t>(10, (size_t(1) << 26) / (n * n));
+    volatile double sink = 0.;
+
+    // Building from a view always allocates and copies, as every copy did before.
+    double deep = Microseconds(repeats, [&] { sink = sink + ReadByValue(Matrix(a.view())); });
+    double shared = Microseconds(repeats, [&] { sink = sink + ReadByValue(a); });
+    double written = Microseconds(repeats, [&] {
+      Matrix copy = a;
+      copy[0][0] = 1.;
+      sink = sink + copy[0][0];
+    });
+
+    std::cout << n << '\t' << deep << '\t' << shared << '\t' << written << std::endl;
+  }
+}
@@ -0,0 +1,45 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/lu.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const size_t sizes[] = {10, 20, 50, 100, 200, 500, 1000, 2000};
+
+  std::cout << "size\tdet seconds\treused det seconds" << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomMatrix(n, n);
+    size_t repeats = std::max<size_t>(1, (size_t(1) << 26) / (n * n * n));
+    volatile double sink = 0.;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i)
+      sink = sink + a.det();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    task::LUDecomposition lu(a);
+    auto reuse_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i)
+      sink = sink + lu.det();
+    std::chrono::duration<double> reuse_elapsed = std::chrono::steady_clock::now() - reuse_start;
+
+    std::cout << n << '\t' << elapsed.count() / repeats << '\t' << reuse_elapsed.count() / repeats << std::endl;
+  }
+}
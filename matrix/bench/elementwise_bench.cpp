@@ -0,0 +1,37 @@
+#include <chrono>
+#include <iostream>
+#include "src/matrix.h"
+#include "src/simd.h"
+
+using task::Matrix;
+
+template<class F>
+double Bandwidth(size_t bytes, F &&op) {
+  const size_t repeats = 20;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return bytes * repeats / elapsed.count() * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? std::stoul(argv[1]) : 2048;
+  const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+  size_t bytes = n * n * sizeof(double);
+
+  Matrix a(n, n), b(n, n), c(n, n);
+  volatile bool sink = false;
+
+  std::cout << "GB/s for " << n << " x " << n << std::endl;
+  std::cout << "level\t+=\t-=\t*= scalar\t==" << std::endl;
+  for (int level = 0; level <= static_cast<int>(task::detectSimdLevel()); ++level) {
+    task::setSimdLevel(static_cast<task::SimdLevel>(level));
+    std::cout << names[level] << '\t'
+              << Bandwidth(3 * bytes, [&] { a += b; }) << '\t'
+              << Bandwidth(3 * bytes, [&] { a -= b; }) << '\t'
+              << Bandwidth(2 * bytes, [&] { a *= 1.0000001; }) << '\t'
+              << Bandwidth(2 * bytes, [&] { sink = sink ^ (b == c); }) << std::endl;
+  }
+}
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+#include "src/fixed_matrix.h"
+
+using task::FixedMatrix;
+using task::Matrix;
+
+template<size_t N>
+std::vector<FixedMatrix<N, N>> RandomMatrices(size_t count) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  std::vector<FixedMatrix<N, N>> temp(count);
+  for (auto &matrix : temp)
+    for (size_t row = 0; row < N; ++row)
+      for (size_t col = 0; col < N; ++col)
+        matrix[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double MillionsPerSecond(size_t count, F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i)
+    op(i);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return count / elapsed.count() * 1e-6;
+}
+
+template<size_t N>
+void Run(size_t count) {
+  auto fixed = RandomMatrices<N>(count);
+  std::vector<Matrix> dynamic;
+  for (const auto &matrix : fixed)
+    dynamic.push_back(Matrix(matrix));
+  volatile double sink = 0.;
+
+  std::cout << N << 'x' << N << "\tMatrix\t"
+            << MillionsPerSecond(count, [&](size_t i) { sink = sink + dynamic[i].det(); }) << '\t'
+            << MillionsPerSecond(count - 1, [&](size_t i) {
+                 sink = sink + Matrix(dynamic[i] * dynamic[i + 1])[0][0];
+               }) << std::endl;
+  std::cout << N << 'x' << N << "\tFixed\t"
+            << MillionsPerSecond(count, [&](size_t i) { sink = sink + fixed[i].det(); }) << '\t'
+            << MillionsPerSecond(count - 1, [&](size_t i) { sink = sink + (fixed[i] * fixed[i + 1])[0][0]; })
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  std::cout << "millions per second for " << count << " matrices" << std::endl;
+  std::cout << "size\ttype\tdet\tproduct" << std::endl;
+  Run<2>(count);
+  Run<3>(count);
+  Run<4>(count);
+}
@@ -0,0 +1,44 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/thread_pool.h"
+
+using task::BasicMatrix;
+
+template<class T>
+BasicMatrix<T> RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  BasicMatrix<T> temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = static_cast<T>(dist(rand));
+  return temp;
+}
+
+template<class T>
+double Gflops(size_t n) {
+  BasicMatrix<T> a = RandomMatrix<T>(n, n);
+  BasicMatrix<T> b = RandomMatrix<T>(n, n);
+  size_t repeats = std::max<size_t>(1, (size_t(1) << 30) / (n * n * n));
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i) {
+    BasicMatrix<T> c = a * b;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  return 2. * n * n * n * repeats / elapsed.count() * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 4096;
+  task::setNumThreads(argc > 2 ? std::stoul(argv[2]) : 0);
+
+  std::cout << "threads: " << task::getNumThreads() << std::endl;
+  std::cout << "size\tdouble GFLOPS\tfloat GFLOPS" << std::endl;
+  for (size_t n = 64; n <= max_size; n *= 2)
+    std::cout << n << '\t' << Gflops<double>(n) << '\t' << Gflops<float>(n) << std::endl;
+}
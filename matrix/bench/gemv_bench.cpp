@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+// GB/s of A streamed per product, averaged over enough repeats to touch ~1 GB.
+template<class F>
+double GigabytesPerSecond(size_t n, F &&op) {
+  size_t repeats = std::max<size_t>(1, (size_t(1) << 27) / (n * n));
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return double(n) * n * sizeof(double) * repeats / elapsed.count() * 1e-9;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 4000;
+  const size_t sizes[] = {100, 500, 1000, 2000, 4000};
+
+  std::cout << "GB/s of A read per product" << std::endl;
+  std::cout << "size\tA * column Matrix\tA * vector\tvector * A\trank-1 update" << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomMatrix(n, n);
+    Matrix column = RandomMatrix(n, 1);
+    std::vector<double> x = column.getColumn(0), y;
+    y.reserve(n);
+    volatile double sink = 0.;
+
+    double matrix = GigabytesPerSecond(n, [&] { sink = sink + Matrix(a * column)[0][0]; });
+    double gemv = GigabytesPerSecond(n, [&] {
+      task::multiply(a, x, y);
+      sink = sink + y[0];
+    });
+    double gevm = GigabytesPerSecond(n, [&] {
+      task::multiply(x, a, y);
+      sink = sink + y[0];
+    });
+    double ger = GigabytesPerSecond(n, [&] { task::rankOneUpdate(a, 1e-9, x, x); });
+
+    std::cout << n << '\t' << matrix << '\t' << gemv << '\t' << gevm << '\t' << ger << std::endl;
+  }
+}
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/matrix_io.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Seconds(F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+double FileSize(const std::string &path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  return static_cast<double>(file.tellg());
+}
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const std::string text_path = "io_bench.txt", binary_path = "io_bench.bin";
+  Matrix a = RandomMatrix(n, n);
+  volatile double sink = 0.;
+
+  std::cout << "seconds for " << n << " x " << n << std::endl;
+  std::cout << "format\twrite\tread\twrite MB/s\tread MB/s" << std::endl;
+  auto report = [](const char *name, double bytes, double write, double read) {
+    std::cout << name << '\t' << write << '\t' << read << '\t' << bytes / write * 1e-6 << '\t' << bytes / read * 1e-6
+              << std::endl;
+  };
+
+  // Element-by-element stream operators with a flush per row, as operator<< / operator>> used to be.
+  double text_write = Seconds([&] {
+    std::ofstream output(text_path);
+    output << n << ' ' << n << std::endl;
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j)
+        output << a[i][j] << ' ';
+      output << std::endl;
+    }
+  });
+  double text_read = Seconds([&] {
+    std::ifstream input(text_path);
+    size_t rows, cols;
+    input >> rows >> cols;
+    Matrix b(rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+      for (size_t j = 0; j < cols; ++j)
+        input >> b[i][j];
+    sink = sink + b[n - 1][n - 1];
+  });
+  report("istream", FileSize(text_path), text_write, text_read);
+
+  double operator_write = Seconds([&] {
+    std::ofstream output(text_path);
+    output << n << ' ' << n << '\n' << a;
+  });
+  double operator_read = Seconds([&] {
+    std::ifstream input(text_path);
+    Matrix b;
+    input >> b;
+    sink = sink + b[n - 1][n - 1];
+  });
+  report("chars", FileSize(text_path), operator_write, operator_read);
+
+  double shortest_write = Seconds([&] {
+    std::ofstream output(text_path);
+    task::writeText(output, a);
+  });
+  double shortest_read = Seconds([&] {
+    std::ifstream input(text_path, std::ios::binary | std::ios::ate);
+    std::string text(input.tellg(), '\0');
+    input.seekg(0);
+    input.read(&text[0], text.size());
+    Matrix b;
+    task::parseText(text.data(), text.data() + text.size(), b);
+    sink = sink + b[n - 1][n - 1];
+  });
+  report("bulk", FileSize(text_path), shortest_write, shortest_read);
+
+  double binary_write = Seconds([&] { task::saveBinary(binary_path, a); });
+  double binary_read = Seconds([&] { sink = sink + task::loadBinary(binary_path)[n - 1][n - 1]; });
+  report("binary", FileSize(binary_path), binary_write, binary_read);
+
+  double mapped_open = Seconds([&] {
+    task::MappedMatrix mapped(binary_path);
+    sink = sink + mapped.view().at(n - 1, n - 1);
+  });
+  std::cout << "mmap\t-\t" << mapped_open << "\t-\t" << FileSize(binary_path) / mapped_open * 1e-6 << std::endl;
+
+  std::remove(text_path.c_str());
+  std::remove(binary_path.c_str());
+}
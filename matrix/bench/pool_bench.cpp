@@ -0,0 +1,59 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/buffer_pool.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-1., 1.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Microseconds(size_t repeats, F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op(i);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repeats * 1e6;
+}
+
+// Shapes oscillate as in an iterative solver: resize back and forth, and a fresh product *= per step.
+void Run(const char *name, size_t n) {
+  Matrix resized = RandomMatrix(n, n);
+  Matrix base = RandomMatrix(n / 4, n / 4), factor = RandomMatrix(n / 4, n / 4);
+  volatile double sink = 0.;
+
+  double resize = Microseconds(1000, [&](size_t i) {
+    resized.resize(i % 2 ? n : n / 2, i % 2 ? n : 2 * n / 3);
+    sink = sink + resized[0][0];
+  });
+  // Restarting from base keeps the values away from denormals.
+  double multiply = Microseconds(1000, [&](size_t) {
+    Matrix product = base;
+    product *= factor;
+    sink = sink + product[0][0];
+  });
+  std::cout << name << '\t' << n << '\t' << resize << '\t' << multiply << std::endl;
+}
+
+int main() {
+  std::cout << "microseconds per call" << std::endl;
+  std::cout << "storage\tsize\tresize\t*=" << std::endl;
+  for (size_t n : {64, 256, 1024})
+    Run("heap", n);
+
+  task::MatrixBufferPool pool;
+  task::setThreadBufferPool(&pool);
+  for (size_t n : {64, 256, 1024})
+    Run("pool", n);
+  task::setThreadBufferPool(nullptr);
+}
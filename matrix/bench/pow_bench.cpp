@@ -0,0 +1,59 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+
+using task::Matrix;
+
+// Row-stochastic, so every power stays bounded like a transition matrix does.
+Matrix RandomTransitionMatrix(size_t size) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{0., 1.};
+
+  Matrix temp(size, size);
+  for (size_t row = 0; row < size; ++row) {
+    double sum = 0.;
+    for (size_t col = 0; col < size; ++col)
+      sum += temp[row][col] = dist(rand);
+    for (size_t col = 0; col < size; ++col)
+      temp[row][col] /= sum;
+  }
+  return temp;
+}
+
+template<class F>
+double Milliseconds(size_t repeats, F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repeats * 1e3;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 256;
+  const size_t sizes[] = {4, 16, 64, 256};
+  const uint64_t powers[] = {10, 100, 1000};
+
+  std::cout << "milliseconds for A^k: k times m *= a, then a.pow(k)" << std::endl;
+  std::cout << "size\tk\tloop\tpow" << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomTransitionMatrix(n);
+    size_t repeats = std::max<size_t>(1, (size_t(1) << 22) / (n * n * n));
+    volatile double sink = 0.;
+
+    for (uint64_t k : powers) {
+      double loop = Milliseconds(repeats, [&] {
+        Matrix m = a;
+        for (uint64_t i = 1; i < k; ++i)
+          m *= a;
+        sink = sink + m[0][0];
+      });
+      double pow = Milliseconds(repeats, [&] { sink = sink + a.pow(k)[0][0]; });
+      std::cout << n << '\t' << k << '\t' << loop << '\t' << pow << std::endl;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include "src/matrix.h"
+
+using task::Matrix;
+
+// Matrix buffers are the only ALIGNMENT-aligned allocations made here, so counting these operator
+// new calls counts the heap traffic of the matrices.
+size_t aligned_allocations = 0;
+
+void *operator new(size_t bytes, std::align_val_t align) {
+  ++aligned_allocations;
+  size_t alignment = static_cast<size_t>(align);
+  void *block = std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment);
+  if (block == nullptr)
+    throw std::bad_alloc();
+  return block;
+}
+
+void operator delete(void *block, std::align_val_t) noexcept { std::free(block); }
+void operator delete(void *block, size_t, std::align_val_t) noexcept { std::free(block); }
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+void Measure(const char *name, size_t repeats, F &&op) {
+  size_t allocations = aligned_allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << '\t' << name << ' ' << elapsed.count() / repeats * 1e9 << " ns, "
+            << double(aligned_allocations - allocations) / repeats << " allocs";
+}
+
+int main(int argc, char **argv) {
+  size_t repeats = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+  std::cout << "inline elements: " << task::MATRIX_INLINE_ELEMENTS << std::endl;
+  for (size_t n = 1; n <= 5; ++n) {
+    Matrix a = RandomMatrix(n, n), b = RandomMatrix(n, n);
+    volatile double sink = 0.;
+
+    std::cout << n << 'x' << n;
+    Measure("identity", repeats, [&] { sink = sink + Matrix(n, n).trace(); });
+    Measure("copy+write", repeats, [&] {
+      Matrix copy = a;
+      copy[0][0] += 1.;
+      sink = sink + copy[0][0];
+    });
+    Measure("product", repeats, [&] { sink = sink + (a * b).trace(); });
+    Measure("sum", repeats, [&] { sink = sink + Matrix(a + b).trace(); });
+    Measure("det", repeats, [&] { sink = sink + a.det(); });
+    std::cout << std::endl;
+  }
+}
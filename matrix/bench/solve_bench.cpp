@@ -0,0 +1,61 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/cholesky.h"
+#include "src/lu.h"
+#include "src/qr.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Seconds(F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 1000;
+  const size_t sizes[] = {100, 200, 500, 1000, 2000};
+
+  std::cout << "factorization GFLOPS, then seconds for one reused solve and for inverse()" << std::endl;
+  std::cout << "size\tLU\tCholesky\tQR\tLU solve\tLU inverse\tCholesky inverse" << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomMatrix(n, n);
+    Matrix spd = a * a.transposed();
+    for (size_t i = 0; i < n; ++i)
+      spd[i][i] += n;
+    std::vector<double> b = a.getColumn(0);
+    double flops = double(n) * n * n;
+    volatile double sink = 0.;
+
+    double lu_seconds = Seconds([&] { sink = sink + task::LUDecomposition(a).det(); });
+    double cholesky_seconds = Seconds([&] { sink = sink + task::CholeskyDecomposition(spd).det(); });
+    double qr_seconds = Seconds([&] { sink = sink + task::QRDecomposition(a).isFullRank(); });
+
+    task::LUDecomposition lu(a);
+    task::CholeskyDecomposition cholesky(spd);
+    double solve_seconds = Seconds([&] { sink = sink + lu.solve(b)[0]; });
+    double lu_inverse_seconds = Seconds([&] { sink = sink + lu.inverse()[0][0]; });
+    double cholesky_inverse_seconds = Seconds([&] { sink = sink + cholesky.inverse()[0][0]; });
+
+    std::cout << n << '\t' << 2. / 3. * flops / lu_seconds * 1e-9 << '\t'
+              << 1. / 3. * flops / cholesky_seconds * 1e-9 << '\t' << 4. / 3. * flops / qr_seconds * 1e-9 << '\t'
+              << solve_seconds << '\t' << lu_inverse_seconds << '\t' << cholesky_inverse_seconds << std::endl;
+  }
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include "src/matrix.h"
+#include "src/strassen.h"
+
+using task::Matrix;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+double TimedProduct(const Matrix &a, const Matrix &b, Matrix &c) {
+  auto start = std::chrono::steady_clock::now();
+  c = a * b;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+double MaxAbs(const Matrix &a) {
+  double max = 0.;
+  for (size_t i = 0; i < a.getNumRows(); ++i)
+    for (size_t j = 0; j < a.getNumCols(); ++j)
+      max = std::max(max, std::fabs(a[i][j]));
+  return max;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 4096;
+  task::setStrassenCrossover(argc > 2 ? std::stoul(argv[2]) : task::STRASSEN_CROSSOVER);
+
+  std::cout << "crossover: " << task::getStrassenCrossover() << std::endl;
+  std::cout << "size\tclassical s\tstrassen s\tmax |diff| / (n max|A| max|B|)" << std::endl;
+  for (size_t n = 1024; n <= max_size; n *= 2) {
+    Matrix a = RandomMatrix(n, n);
+    Matrix b = RandomMatrix(n, n);
+    Matrix classical, fast;
+
+    task::setStrassenEnabled(false);
+    double classical_time = TimedProduct(a, b, classical);
+    task::setStrassenEnabled(true);
+    double fast_time = TimedProduct(a, b, fast);
+
+    double error = MaxAbs(fast - classical) / (n * MaxAbs(a) * MaxAbs(b));
+    std::cout << n << '\t' << classical_time << '\t' << fast_time << '\t' << error << std::endl;
+  }
+}
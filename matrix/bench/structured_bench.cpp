@@ -0,0 +1,75 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/matrix.h"
+#include "src/structured_matrix.h"
+
+using task::BandMatrix;
+using task::Matrix;
+using task::SymmetricMatrix;
+using task::TriangularMatrix;
+
+const size_t BANDWIDTH = 8;
+const size_t RHS_COLS = 64;
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+  static std::mt19937 rand(42);
+  std::uniform_real_distribution<double> dist{-10., 10.};
+
+  Matrix temp(rows, cols);
+  for (size_t row = 0; row < rows; ++row)
+    for (size_t col = 0; col < cols; ++col)
+      temp[row][col] = dist(rand);
+  return temp;
+}
+
+template<class F>
+double Milliseconds(size_t repeats, F &&op) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < repeats; ++i)
+    op();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repeats * 1e3;
+}
+
+// Milliseconds for A x, A B with RHS_COLS columns and det, dense first and then structured.
+template<class S>
+void Compare(const char *name, const S &structured, const Matrix &b, const std::vector<double> &x) {
+  Matrix dense = structured.toDense();
+  size_t repeats = std::max<size_t>(1, 200000000 / (dense.getNumRows() * dense.getNumRows() * RHS_COLS));
+  volatile double sink = 0.;
+
+  std::cout << name;
+  for (bool use_dense : {true, false}) {
+    double mv = Milliseconds(repeats * 10, [&] {
+      sink = sink + (use_dense ? dense * x : structured * x)[0];
+    });
+    double mm = Milliseconds(repeats, [&] { sink = sink + (use_dense ? dense * b : structured * b)[0][0]; });
+    double det = Milliseconds(1, [&] { sink = sink + (use_dense ? dense.det() : structured.det()); });
+    std::cout << '\t' << mv << '\t' << mm << '\t' << det;
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char **argv) {
+  size_t max_size = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const size_t sizes[] = {250, 500, 1000, 2000};
+
+  std::cout << "milliseconds; A x, A B (" << RHS_COLS << " columns) and det for dense, then for structured"
+            << std::endl;
+  for (size_t n : sizes) {
+    if (n > max_size)
+      break;
+    Matrix a = RandomMatrix(n, n);
+    Matrix b = RandomMatrix(n, RHS_COLS);
+    std::vector<double> x(n, 1.);
+    // A A^T + n I keeps the symmetric elimination on its packed path.
+    Matrix covariance = a * a.transposed() + Matrix(n, n) * double(n);
+
+    std::cout << "size " << n << "\tdense x\tdense B\tdense det\tx\tB\tdet" << std::endl;
+    Compare("symmetric", SymmetricMatrix(covariance), b, x);
+    Compare("triangular", TriangularMatrix(a), b, x);
+    Compare("band", BandMatrix(a, BANDWIDTH), b, x);
+  }
+}
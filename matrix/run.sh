@@ -3,11 +3,18 @@
 set -e
 
 STRESS_TEST_COUNT=500
+SOURCES="src/matrix.cpp src/buffer_pool.cpp src/gemm.cpp src/thread_pool.cpp src/lu.cpp src/cholesky.cpp src/qr.cpp src/strassen.cpp src/matrix_view.cpp src/simd.cpp src/sparse_matrix.cpp src/matrix_io.cpp src/matrix_batch.cpp src/matrix_chain.cpp src/structured_matrix.cpp src/matrix_stats.cpp"
 
-g++ -std=c++17 -I./ test/test.cpp src/matrix.cpp -o matrix_test
+g++ -std=c++17 -I./ test/test.cpp $SOURCES -pthread -o matrix_test
 python3 test/generate.py $STRESS_TEST_COUNT > test_data
 ./matrix_test $STRESS_TEST_COUNT < test_data
 
 rm test_data
 
+# The operation counters only exist when every source is built with TASK_MATRIX_STATS.
+g++ -std=c++17 -DTASK_MATRIX_STATS -I./ test/stats_test.cpp $SOURCES -pthread -o matrix_stats_test
+./matrix_stats_test
+
+rm matrix_stats_test
+
 echo All tests passed!
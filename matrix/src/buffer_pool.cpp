@@ -0,0 +1,74 @@
+#include <new>
+#include "buffer_pool.h"
+#include "matrix.h"
+
+using namespace task;
+
+namespace {
+
+thread_local MatrixBufferPool *thread_pool = nullptr;
+
+void *heap_block(size_t bytes) { return ::operator new(bytes, std::align_val_t(ALIGNMENT)); }
+
+void free_block(void *block) { ::operator delete(block, std::align_val_t(ALIGNMENT)); }
+
+// Index of the largest power of two not above bytes, and of the smallest one not below it.
+size_t floor_bucket(size_t bytes) { return 63 - __builtin_clzll(bytes); }
+
+size_t ceil_bucket(size_t bytes) { return bytes <= 1 ? 0 : floor_bucket(bytes - 1) + 1; }
+
+}  // namespace
+
+MatrixBufferPool::MatrixBufferPool(size_t max_cached_bytes)
+    : buckets(64), cached_bytes(0), max_cached_bytes(max_cached_bytes) {}
+
+MatrixBufferPool::~MatrixBufferPool() {
+  for (const auto &bucket : this->buckets)
+    for (const auto &block : bucket)
+      free_block(block.first);
+}
+
+void *MatrixBufferPool::acquire(size_t bytes, size_t &size) {
+  size_t bucket = ceil_bucket(bytes);
+
+  if (!this->buckets[bucket].empty()) {
+    auto block = this->buckets[bucket].back();
+    this->buckets[bucket].pop_back();
+    this->cached_bytes -= block.second;
+    size = block.second;
+    return block.first;
+  }
+  // Round new blocks up to the bucket size, so they serve every later request of that bucket.
+  size = size_t(1) << bucket;
+  return heap_block(size);
+}
+
+void MatrixBufferPool::release(void *block, size_t size) {
+  if (this->cached_bytes + size > this->max_cached_bytes) {
+    free_block(block);
+    return;
+  }
+  this->buckets[floor_bucket(size)].emplace_back(block, size);
+  this->cached_bytes += size;
+}
+
+size_t MatrixBufferPool::getCachedBytes() const { return this->cached_bytes; }
+
+void task::setThreadBufferPool(MatrixBufferPool *pool) { thread_pool = pool; }
+
+MatrixBufferPool *task::getThreadBufferPool() { return thread_pool; }
+
+void *task::allocateBuffer(size_t bytes, size_t &size, bool exact) {
+  if (thread_pool == nullptr or exact) {
+    size = bytes;
+    return heap_block(bytes);
+  }
+  return thread_pool->acquire(bytes, size);
+}
+
+void task::releaseBuffer(void *block, size_t size) {
+  if (thread_pool == nullptr)
+    free_block(block);
+  else
+    thread_pool->release(block, size);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace task {
+
+// Bytes a pool keeps in its free lists by default before it starts returning blocks to the heap.
+const size_t POOL_MAX_CACHED_BYTES = size_t(64) << 20;
+
+// Free lists of ALIGNMENT-aligned blocks bucketed by powers of two: a released block goes to the
+// bucket of the largest power of two it can hold, and acquire() serves a request from the bucket of
+// the next power of two up, so any block handed out is large enough. Not thread-safe: a pool
+// serves the thread it is plugged into with setThreadBufferPool.
+class MatrixBufferPool {
+ public:
+  explicit MatrixBufferPool(size_t max_cached_bytes = POOL_MAX_CACHED_BYTES);
+  MatrixBufferPool(const MatrixBufferPool &) = delete;
+  MatrixBufferPool &operator=(const MatrixBufferPool &) = delete;
+  ~MatrixBufferPool();
+
+  // A block of at least bytes bytes; its actual size is stored in size.
+  void *acquire(size_t bytes, size_t &size);
+  // Takes back a block of size bytes, from any pool or from the heap.
+  void release(void *block, size_t size);
+
+  size_t getCachedBytes() const;
+
+ private:
+  std::vector<std::vector<std::pair<void *, size_t>>> buckets;
+  size_t cached_bytes;
+  size_t max_cached_bytes;
+};
+
+// Pool that matrix buffers of the calling thread are taken from and returned to; nullptr (the
+// default) allocates every buffer from the heap. A pool must not be destroyed while plugged in.
+void setThreadBufferPool(MatrixBufferPool *pool);
+MatrixBufferPool *getThreadBufferPool();
+
+// ALIGNMENT-aligned block of at least bytes bytes through the thread's pool, its size stored in
+// size; exact skips the pool's rounding up and takes a block of exactly bytes from the heap.
+void *allocateBuffer(size_t bytes, size_t &size, bool exact = false);
+void releaseBuffer(void *block, size_t size);
+
+}  // namespace task
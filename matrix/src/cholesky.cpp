@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include "cholesky.h"
+#include "gemm.h"
+
+using namespace task;
+
+CholeskyDecomposition::CholeskyDecomposition(const Matrix &a) : l(a) {
+  size_t n = a.getNumRows();
+
+  if (n != a.getNumCols())
+    throw SizeMismatchException();
+
+  for (size_t k0 = 0; k0 < n; k0 += CHOLESKY_BLOCK) {
+    size_t kb = std::min(CHOLESKY_BLOCK, n - k0);
+    factor_diagonal(k0, kb);
+    update_trailing(k0, kb);
+  }
+  for (size_t i = 0; i < n; ++i)
+    std::fill(this->l[i] + i + 1, this->l[i] + n, 0.);
+}
+
+// Unblocked Cholesky of the diagonal block, whose trailing updates are already applied.
+void CholeskyDecomposition::factor_diagonal(size_t k0, size_t kb) {
+  for (size_t j = k0; j < k0 + kb; ++j) {
+    double *row_j = this->l[j];
+    double diagonal = row_j[j];
+    for (size_t p = k0; p < j; ++p)
+      diagonal -= row_j[p] * row_j[p];
+    if (!(diagonal > 0.))
+      throw NotPositiveDefiniteException();
+    row_j[j] = std::sqrt(diagonal);
+
+    for (size_t i = j + 1; i < k0 + kb; ++i) {
+      double *row_i = this->l[i];
+      double value = row_i[j];
+      for (size_t p = k0; p < j; ++p)
+        value -= row_i[p] * row_j[p];
+      row_i[j] = value / row_j[j];
+    }
+  }
+}
+
+// L21 = A21 L11^-T row by row, then A22 -= L21 L21^T as one gemm with the negated L21 panel.
+void CholeskyDecomposition::update_trailing(size_t k0, size_t kb) {
+  size_t n = size();
+  size_t j0 = k0 + kb;
+
+  if (j0 == n)
+    return;
+
+  for (size_t i = j0; i < n; ++i) {
+    double *row_i = this->l[i];
+    for (size_t j = k0; j < j0; ++j) {
+      const double *row_j = this->l[j];
+      double value = row_i[j];
+      for (size_t p = k0; p < j; ++p)
+        value -= row_i[p] * row_j[p];
+      row_i[j] = value / row_j[j];
+    }
+  }
+
+  size_t m = n - j0;
+  std::vector<double> panel(m * kb);
+  for (size_t i = 0; i < m; ++i)
+    for (size_t p = 0; p < kb; ++p)
+      panel[i * kb + p] = -this->l[j0 + i][k0 + p];
+
+  // The upper triangle of A22 is updated too and cleared at the end; one full gemm is faster
+  // than splitting the update into triangular tiles at these sizes.
+  size_t stride = this->l.view().getRowStride();
+  gemm(m, m, kb, panel.data(), kb, 1, this->l[j0] + k0, 1, stride, this->l[j0] + j0, stride);
+}
+
+size_t CholeskyDecomposition::size() const { return this->l.getNumRows(); }
+
+double CholeskyDecomposition::det() const {
+  double det = 1.;
+  for (size_t i = 0; i < size(); ++i)
+    det *= this->l[i][i];
+  return det * det;
+}
+
+Matrix CholeskyDecomposition::getL() const { return this->l; }
+
+std::vector<double> CholeskyDecomposition::solve(const std::vector<double> &b) const {
+  if (b.size() != size())
+    throw SizeMismatchException();
+
+  size_t n = size();
+  std::vector<double> x(b);
+
+  for (size_t i = 0; i < n; ++i) {
+    const double *row = this->l[i];
+    for (size_t j = 0; j < i; ++j)
+      x[i] -= row[j] * x[j];
+    x[i] /= row[i];
+  }
+  // L^T is walked by rows of L: once x[i] is final it is subtracted from every x[j], j < i.
+  for (size_t i = n; i-- > 0;) {
+    const double *row = this->l[i];
+    x[i] /= row[i];
+    for (size_t j = 0; j < i; ++j)
+      x[j] -= row[j] * x[i];
+  }
+  return x;
+}
+
+Matrix CholeskyDecomposition::solve(const Matrix &b) const {
+  if (b.getNumRows() != size())
+    throw SizeMismatchException();
+
+  size_t n = size();
+  size_t m = b.getNumCols();
+  Matrix x(b);
+
+  size_t stride = this->l.view().getRowStride();
+  size_t x_stride = x.view().getRowStride();
+  trsm(true, false, n, m, this->l[0], stride, 1, x[0], x_stride);
+  trsm(false, false, n, m, this->l[0], 1, stride, x[0], x_stride);
+  return x;
+}
+
+Matrix CholeskyDecomposition::inverse() const { return solve(Matrix(size(), size())); }
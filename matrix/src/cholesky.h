@@ -0,0 +1,36 @@
+#pragma once
+
+#include <exception>
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+class NotPositiveDefiniteException : public std::exception {};
+
+// Columns factored per panel, as LU_BLOCK for LUDecomposition.
+const size_t CHOLESKY_BLOCK = 64;
+
+// A = L L^T for a symmetric positive definite A, computed once and reused by det() and every
+// solve(). Only the lower triangle of A is read; throws NotPositiveDefiniteException when a
+// diagonal element of L would not be positive.
+class CholeskyDecomposition {
+ public:
+  explicit CholeskyDecomposition(const Matrix &a);
+
+  size_t size() const;
+  double det() const;
+  Matrix getL() const;
+
+  std::vector<double> solve(const std::vector<double> &b) const;
+  Matrix solve(const Matrix &b) const;
+  Matrix inverse() const;
+
+ private:
+  Matrix l;
+
+  void factor_diagonal(size_t k0, size_t kb);
+  void update_trailing(size_t k0, size_t kb);
+};
+
+}  // namespace task
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// R x C matrix with inline storage and constexpr arithmetic for the small sizes geometry code
+// uses by the million. It mirrors the Matrix interface; shape errors that Matrix reports with
+// SizeMismatchException are compile errors here. det() and inverse() have closed forms up to 4 x 4
+// and fall back to Gaussian elimination above that. Conversions to and from Matrix are explicit.
+template<size_t R, size_t C>
+class FixedMatrix {
+  static_assert(R > 0 and C > 0, "FixedMatrix dimensions must be positive");
+
+ public:
+  // Like Matrix: ones on the main diagonal, zeros elsewhere.
+  constexpr FixedMatrix();
+  // Throws SizeMismatchException unless matrix is R x C.
+  explicit FixedMatrix(const Matrix &matrix);
+  explicit operator Matrix() const;
+
+  constexpr double &get(size_t row, size_t col);
+  constexpr const double &get(size_t row, size_t col) const;
+  constexpr void set(size_t row, size_t col, const double &value);
+
+  constexpr double *operator[](size_t row) { return this->values[row]; }
+  constexpr const double *operator[](size_t row) const { return this->values[row]; }
+
+  constexpr FixedMatrix &operator+=(const FixedMatrix &a);
+  constexpr FixedMatrix &operator-=(const FixedMatrix &a);
+  constexpr FixedMatrix &operator*=(const double &number);
+  constexpr FixedMatrix &operator*=(const FixedMatrix<C, C> &a);
+
+  constexpr FixedMatrix operator+(const FixedMatrix &a) const;
+  constexpr FixedMatrix operator-(const FixedMatrix &a) const;
+  constexpr FixedMatrix operator*(const double &number) const;
+  template<size_t K>
+  constexpr FixedMatrix<R, K> operator*(const FixedMatrix<C, K> &a) const;
+
+  constexpr FixedMatrix operator-() const;
+  constexpr FixedMatrix operator+() const;
+
+  constexpr double det() const;
+  // Throws SingularMatrixException when det() is exactly zero.
+  constexpr FixedMatrix inverse() const;
+  constexpr void transpose();
+  constexpr FixedMatrix<C, R> transposed() const;
+  constexpr double trace() const;
+
+  std::vector<double> getRow(size_t row) const;
+  std::vector<double> getColumn(size_t column) const;
+
+  MatrixView view() const;
+
+  constexpr bool operator==(const FixedMatrix &a) const;
+  constexpr bool operator!=(const FixedMatrix &a) const;
+
+  constexpr size_t getNumCols() const { return C; }
+  constexpr size_t getNumRows() const { return R; }
+
+ private:
+  double values[R][C]{};
+
+  static constexpr double abs(double value) { return value < 0. ? -value : value; }
+};
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> operator*(const double &number, const FixedMatrix<R, C> &a) { return a * number; }
+
+template<size_t R, size_t C>
+std::ostream &operator<<(std::ostream &output, const FixedMatrix<R, C> &matrix) {
+  for (size_t i = 0; i < R; ++i) {
+    for (size_t j = 0; j < C; ++j)
+      output << matrix[i][j] << ' ';
+    output << '\n';
+  }
+  return output;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C>::FixedMatrix() {
+  for (size_t i = 0; i < R and i < C; ++i)
+    this->values[i][i] = 1.;
+}
+
+template<size_t R, size_t C>
+FixedMatrix<R, C>::FixedMatrix(const Matrix &matrix) {
+  if (matrix.getNumRows() != R or matrix.getNumCols() != C)
+    throw SizeMismatchException();
+
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      this->values[i][j] = matrix[i][j];
+}
+
+template<size_t R, size_t C>
+FixedMatrix<R, C>::operator Matrix() const {
+  return Matrix(view());
+}
+
+template<size_t R, size_t C>
+constexpr double &FixedMatrix<R, C>::get(size_t row, size_t col) {
+  if (row >= R or col >= C)
+    throw OutOfBoundsException();
+  return this->values[row][col];
+}
+
+template<size_t R, size_t C>
+constexpr const double &FixedMatrix<R, C>::get(size_t row, size_t col) const {
+  if (row >= R or col >= C)
+    throw OutOfBoundsException();
+  return this->values[row][col];
+}
+
+template<size_t R, size_t C>
+constexpr void FixedMatrix<R, C>::set(size_t row, size_t col, const double &value) {
+  get(row, col) = value;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> &FixedMatrix<R, C>::operator+=(const FixedMatrix &a) {
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      this->values[i][j] += a.values[i][j];
+  return *this;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> &FixedMatrix<R, C>::operator-=(const FixedMatrix &a) {
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      this->values[i][j] -= a.values[i][j];
+  return *this;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> &FixedMatrix<R, C>::operator*=(const double &number) {
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      this->values[i][j] *= number;
+  return *this;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> &FixedMatrix<R, C>::operator*=(const FixedMatrix<C, C> &a) {
+  *this = *this * a;
+  return *this;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::operator+(const FixedMatrix &a) const {
+  FixedMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::operator-(const FixedMatrix &a) const {
+  FixedMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::operator*(const double &number) const {
+  FixedMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+template<size_t R, size_t C>
+template<size_t K>
+constexpr FixedMatrix<R, K> FixedMatrix<R, C>::operator*(const FixedMatrix<C, K> &a) const {
+  FixedMatrix<R, K> new_mat;
+
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < K; ++j) {
+      double sum = 0.;
+      for (size_t k = 0; k < C; ++k)
+        sum += this->values[i][k] * a[k][j];
+      new_mat[i][j] = sum;
+    }
+  return new_mat;
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::operator-() const { return *this * -1.; }
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::operator+() const { return *this; }
+
+template<size_t R, size_t C>
+constexpr double FixedMatrix<R, C>::det() const {
+  static_assert(R == C, "det() needs a square matrix");
+  const auto &m = this->values;
+
+  if constexpr (R == 1) {
+    return m[0][0];
+  } else if constexpr (R == 2) {
+    return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  } else if constexpr (R == 3) {
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+        - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+        + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+  } else if constexpr (R == 4) {
+    // Laplace expansion along the first two rows: 2 x 2 minors of the top rows times the
+    // complementary minors of the bottom rows.
+    double s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    double s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    double s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    double s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    double s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    double s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    double c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    double c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    double c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    double c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    double c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    double c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  } else {
+    FixedMatrix lu(*this);
+    double det = 1.;
+
+    for (size_t k = 0; k < R; ++k) {
+      size_t pivot = k;
+      for (size_t i = k + 1; i < R; ++i)
+        if (abs(lu.values[i][k]) > abs(lu.values[pivot][k]))
+          pivot = i;
+      if (lu.values[pivot][k] == 0.)
+        return 0.;
+      if (pivot != k) {
+        for (size_t j = k; j < R; ++j) {
+          double temp = lu.values[k][j];
+          lu.values[k][j] = lu.values[pivot][j];
+          lu.values[pivot][j] = temp;
+        }
+        det = -det;
+      }
+
+      det *= lu.values[k][k];
+      for (size_t i = k + 1; i < R; ++i) {
+        double factor = lu.values[i][k] / lu.values[k][k];
+        for (size_t j = k + 1; j < R; ++j)
+          lu.values[i][j] -= factor * lu.values[k][j];
+      }
+    }
+    return det;
+  }
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<R, C> FixedMatrix<R, C>::inverse() const {
+  static_assert(R == C, "inverse() needs a square matrix");
+  const auto &m = this->values;
+  FixedMatrix inv;
+
+  if constexpr (R == 1) {
+    if (m[0][0] == 0.)
+      throw SingularMatrixException();
+    inv.values[0][0] = 1. / m[0][0];
+  } else if constexpr (R == 2) {
+    double det = this->det();
+    if (det == 0.)
+      throw SingularMatrixException();
+    inv.values[0][0] = m[1][1] / det;
+    inv.values[0][1] = -m[0][1] / det;
+    inv.values[1][0] = -m[1][0] / det;
+    inv.values[1][1] = m[0][0] / det;
+  } else if constexpr (R == 3) {
+    double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+    if (det == 0.)
+      throw SingularMatrixException();
+    double inv_det = 1. / det;
+
+    inv.values[0][0] = c00 * inv_det;
+    inv.values[1][0] = c01 * inv_det;
+    inv.values[2][0] = c02 * inv_det;
+    inv.values[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv_det;
+    inv.values[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv_det;
+    inv.values[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv_det;
+    inv.values[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv_det;
+    inv.values[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv_det;
+    inv.values[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv_det;
+  } else if constexpr (R == 4) {
+    // Adjugate from the same 2 x 2 minors det() uses.
+    double s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    double s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    double s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    double s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    double s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    double s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    double c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    double c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    double c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    double c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    double c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    double c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+    double det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0.)
+      throw SingularMatrixException();
+    double inv_det = 1. / det;
+
+    inv.values[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_det;
+    inv.values[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv_det;
+    inv.values[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_det;
+    inv.values[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv_det;
+    inv.values[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv_det;
+    inv.values[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_det;
+    inv.values[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv_det;
+    inv.values[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_det;
+    inv.values[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_det;
+    inv.values[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv_det;
+    inv.values[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_det;
+    inv.values[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv_det;
+    inv.values[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv_det;
+    inv.values[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_det;
+    inv.values[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv_det;
+    inv.values[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_det;
+  } else {
+    // Gauss-Jordan with partial pivoting, reducing a copy to the identity while inv follows.
+    FixedMatrix a(*this);
+
+    for (size_t k = 0; k < R; ++k) {
+      size_t pivot = k;
+      for (size_t i = k + 1; i < R; ++i)
+        if (abs(a.values[i][k]) > abs(a.values[pivot][k]))
+          pivot = i;
+      if (a.values[pivot][k] == 0.)
+        throw SingularMatrixException();
+      for (size_t j = 0; j < R; ++j) {
+        double temp = a.values[k][j];
+        a.values[k][j] = a.values[pivot][j];
+        a.values[pivot][j] = temp;
+        temp = inv.values[k][j];
+        inv.values[k][j] = inv.values[pivot][j];
+        inv.values[pivot][j] = temp;
+      }
+
+      double inv_pivot = 1. / a.values[k][k];
+      for (size_t j = 0; j < R; ++j) {
+        a.values[k][j] *= inv_pivot;
+        inv.values[k][j] *= inv_pivot;
+      }
+      for (size_t i = 0; i < R; ++i) {
+        if (i == k)
+          continue;
+        double factor = a.values[i][k];
+        for (size_t j = 0; j < R; ++j) {
+          a.values[i][j] -= factor * a.values[k][j];
+          inv.values[i][j] -= factor * inv.values[k][j];
+        }
+      }
+    }
+  }
+  return inv;
+}
+
+template<size_t R, size_t C>
+constexpr void FixedMatrix<R, C>::transpose() {
+  static_assert(R == C, "transpose() in place needs a square matrix, use transposed()");
+
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = i + 1; j < C; ++j) {
+      double temp = this->values[i][j];
+      this->values[i][j] = this->values[j][i];
+      this->values[j][i] = temp;
+    }
+}
+
+template<size_t R, size_t C>
+constexpr FixedMatrix<C, R> FixedMatrix<R, C>::transposed() const {
+  FixedMatrix<C, R> new_mat;
+
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      new_mat[j][i] = this->values[i][j];
+  return new_mat;
+}
+
+template<size_t R, size_t C>
+constexpr double FixedMatrix<R, C>::trace() const {
+  static_assert(R == C, "trace() needs a square matrix");
+  double trace = 0.;
+
+  for (size_t i = 0; i < R; ++i)
+    trace += this->values[i][i];
+  return trace;
+}
+
+template<size_t R, size_t C>
+std::vector<double> FixedMatrix<R, C>::getRow(size_t row) const {
+  if (row >= R)
+    throw OutOfBoundsException();
+  return std::vector<double>(this->values[row], this->values[row] + C);
+}
+
+template<size_t R, size_t C>
+std::vector<double> FixedMatrix<R, C>::getColumn(size_t column) const {
+  if (column >= C)
+    throw OutOfBoundsException();
+
+  std::vector<double> col_vec(R);
+  for (size_t i = 0; i < R; ++i)
+    col_vec[i] = this->values[i][column];
+  return col_vec;
+}
+
+template<size_t R, size_t C>
+MatrixView FixedMatrix<R, C>::view() const {
+  return MatrixView(&this->values[0][0], R, C, C, 1);
+}
+
+template<size_t R, size_t C>
+constexpr bool FixedMatrix<R, C>::operator==(const FixedMatrix &a) const {
+  for (size_t i = 0; i < R; ++i)
+    for (size_t j = 0; j < C; ++j)
+      if (abs(this->values[i][j] - a.values[i][j]) > EPS)
+        return false;
+  return true;
+}
+
+template<size_t R, size_t C>
+constexpr bool FixedMatrix<R, C>::operator!=(const FixedMatrix &a) const { return !(*this == a); }
+
+}  // namespace task
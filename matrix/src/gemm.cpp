@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "gemm.h"
+#include "buffer_pool.h"
+#include "matrix.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+using namespace task;
+
+namespace {
+
+const size_t SMALL_GEMM_VOLUME = 32 * 32 * 32;
+
+std::atomic<size_t> parallel_cutoff(GEMM_PARALLEL_CUTOFF);
+
+// Register block of the micro-kernel for element type T: MR rows by two 32-byte vectors, so
+// NR is 8 for double (GEMM_NR) and 16 for float and int.
+template<class T>
+struct RegisterBlock {
+  static const size_t MR = GEMM_MR;
+  static const size_t NR = 2 * 32 / sizeof(T);
+};
+
+static_assert(RegisterBlock<double>::NR == GEMM_NR, "double register block must match GEMM_NR");
+
+// Pack panels come from the calling thread's buffer pool when one is plugged in, so a run of
+// products reuses the same panels instead of going back to the heap for every call.
+template<class T>
+T *alloc_panel(size_t count, size_t &bytes) { return static_cast<T *>(allocateBuffer(count * sizeof(T), bytes)); }
+
+void free_panel(void *panel, size_t bytes) { releaseBuffer(panel, bytes); }
+
+template<class T>
+void gemm_small(size_t m, size_t n, size_t k,
+                const T *a, size_t rsa, size_t csa,
+                const T *b, size_t rsb, size_t csb,
+                T *c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i) {
+    T *c_row = c + i * ldc;
+    for (size_t p = 0; p < k; ++p) {
+      const T a_ip = a[i * rsa + p * csa];
+      const T *b_row = b + p * rsb;
+      for (size_t j = 0; j < n; ++j)
+        c_row[j] += a_ip * b_row[j * csb];
+    }
+  }
+}
+
+// Packs an mc x kc block of A into MR-row slivers, each stored column by column and zero-padded to MR rows.
+template<class T>
+void pack_a(size_t mc, size_t kc, const T *a, size_t rsa, size_t csa, T *packed) {
+  const size_t MR = RegisterBlock<T>::MR;
+
+  for (size_t i = 0; i < mc; i += MR) {
+    size_t mr = std::min(MR, mc - i);
+    for (size_t p = 0; p < kc; ++p) {
+      for (size_t r = 0; r < mr; ++r)
+        packed[r] = a[(i + r) * rsa + p * csa];
+      for (size_t r = mr; r < MR; ++r)
+        packed[r] = 0;
+      packed += MR;
+    }
+  }
+}
+
+// Packs a kc x nc panel of B into NR-column slivers, each stored row by row and zero-padded to NR columns.
+template<class T>
+void pack_b(size_t kc, size_t nc, const T *b, size_t rsb, size_t csb, T *packed) {
+  const size_t NR = RegisterBlock<T>::NR;
+
+  for (size_t j = 0; j < nc; j += NR) {
+    size_t nr = std::min(NR, nc - j);
+    for (size_t p = 0; p < kc; ++p) {
+      const T *b_row = b + p * rsb + j * csb;
+      for (size_t r = 0; r < nr; ++r)
+        packed[r] = b_row[r * csb];
+      for (size_t r = nr; r < NR; ++r)
+        packed[r] = 0;
+      packed += NR;
+    }
+  }
+}
+
+// MR x NR block of C += packed A sliver * packed B sliver; the 2 * MR accumulators live in registers.
+// A vector is 32 bytes: one AVX register, or a pair of SSE2 registers on older targets.
+template<class T>
+void micro_kernel(size_t kc, const T *a, const T *b, T *c, size_t ldc, size_t mr, size_t nr) {
+  typedef T vec __attribute__((vector_size(32)));
+  const size_t MR = RegisterBlock<T>::MR, NR = RegisterBlock<T>::NR, LANES = NR / 2;
+  vec acc[MR][2] = {};
+
+  for (size_t p = 0; p < kc; ++p) {
+    vec b_lo, b_hi;
+    std::memcpy(&b_lo, b, sizeof(vec));
+    std::memcpy(&b_hi, b + LANES, sizeof(vec));
+    for (size_t i = 0; i < MR; ++i) {
+      acc[i][0] += a[i] * b_lo;
+      acc[i][1] += a[i] * b_hi;
+    }
+    a += MR;
+    b += NR;
+  }
+
+  T result[MR][NR];
+  std::memcpy(result, acc, sizeof(result));
+  for (size_t i = 0; i < mr; ++i)
+    for (size_t j = 0; j < nr; ++j)
+      c[i * ldc + j] += result[i][j];
+}
+
+template<class T>
+void macro_kernel(size_t mc, size_t nc, size_t kc, const T *packed_a, const T *packed_b, T *c, size_t ldc) {
+  const size_t MR = RegisterBlock<T>::MR, NR = RegisterBlock<T>::NR;
+
+  for (size_t j = 0; j < nc; j += NR) {
+    size_t nr = std::min(NR, nc - j);
+    for (size_t i = 0; i < mc; i += MR) {
+      size_t mr = std::min(MR, mc - i);
+      micro_kernel(kc, packed_a + i * kc, packed_b + j * kc, c + i * ldc + j, ldc, mr, nr);
+    }
+  }
+}
+
+template<class T>
+void gemm_blocked(size_t m, size_t n, size_t k,
+                  const T *a, size_t rsa, size_t csa,
+                  const T *b, size_t rsb, size_t csb,
+                  T *c, size_t ldc) {
+  const size_t MR = RegisterBlock<T>::MR, NR = RegisterBlock<T>::NR;
+  size_t nc_max = std::min(GEMM_NC, (n + NR - 1) / NR * NR);
+  size_t mc_max = std::min(GEMM_MC, (m + MR - 1) / MR * MR);
+  size_t bytes_a, bytes_b;
+  T *packed_a = alloc_panel<T>(mc_max * GEMM_KC, bytes_a);
+  T *packed_b = alloc_panel<T>(GEMM_KC * nc_max, bytes_b);
+
+  for (size_t jc = 0; jc < n; jc += GEMM_NC) {
+    size_t nc = std::min(GEMM_NC, n - jc);
+    for (size_t pc = 0; pc < k; pc += GEMM_KC) {
+      size_t kc = std::min(GEMM_KC, k - pc);
+      pack_b(kc, nc, b + pc * rsb + jc * csb, rsb, csb, packed_b);
+      for (size_t ic = 0; ic < m; ic += GEMM_MC) {
+        size_t mc = std::min(GEMM_MC, m - ic);
+        pack_a(mc, kc, a + ic * rsa + pc * csa, rsa, csa, packed_a);
+        macro_kernel(mc, nc, kc, packed_a, packed_b, c + ic * ldc + jc, ldc);
+      }
+    }
+  }
+
+  free_panel(packed_a, bytes_a);
+  free_panel(packed_b, bytes_b);
+}
+
+template<class T>
+void gemm_impl(size_t m, size_t n, size_t k,
+               const T *a, size_t rsa, size_t csa,
+               const T *b, size_t rsb, size_t csb,
+               T *c, size_t ldc) {
+  if (m * n * k <= SMALL_GEMM_VOLUME) {
+    gemm_small(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+    return;
+  }
+
+  ThreadPool &pool = defaultThreadPool();
+  if (m * n * k < parallel_cutoff or pool.getNumThreads() == 1) {
+    gemm_blocked(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+    return;
+  }
+
+  size_t row_tiles = (m + GEMM_MC - 1) / GEMM_MC;
+  size_t col_tiles = (n + GEMM_TILE_N - 1) / GEMM_TILE_N;
+  pool.parallelFor(row_tiles * col_tiles, [&](size_t tile) {
+    size_t ic = tile / col_tiles * GEMM_MC;
+    size_t jc = tile % col_tiles * GEMM_TILE_N;
+    gemm_blocked(std::min(GEMM_MC, m - ic), std::min(GEMM_TILE_N, n - jc), k,
+                 a + ic * rsa, rsa, csa, b + jc * csb, rsb, csb, c + ic * ldc + jc, ldc);
+  });
+}
+
+}  // namespace
+
+void task::setGemmParallelCutoff(size_t volume) { parallel_cutoff = volume; }
+
+size_t task::getGemmParallelCutoff() { return parallel_cutoff; }
+
+void task::gemm(size_t m, size_t n, size_t k,
+                const double *a, size_t lda,
+                const double *b, size_t ldb,
+                double *c, size_t ldc) {
+  gemm(m, n, k, a, lda, 1, b, ldb, 1, c, ldc);
+}
+
+void task::gemm(size_t m, size_t n, size_t k,
+                const double *a, size_t rsa, size_t csa,
+                const double *b, size_t rsb, size_t csb,
+                double *c, size_t ldc) {
+  gemm_impl(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+void task::trsm(bool lower, bool unit_diagonal, size_t n, size_t m,
+                const double *t, size_t rst, size_t cst,
+                double *b, size_t ldb) {
+  std::vector<double> panel;
+
+  for (size_t block = 0; block < n; block += TRSM_BLOCK) {
+    // Lower T walks the blocks of B top-down, upper T bottom-up; [done_begin, done_end) are the
+    // rows already solved.
+    size_t rows = std::min(TRSM_BLOCK, n - block);
+    size_t i0 = lower ? block : n - block - rows;
+    size_t done_begin = lower ? 0 : i0 + rows;
+    size_t done_end = lower ? i0 : n;
+    size_t k = done_end - done_begin;
+
+    if (k != 0) {
+      panel.resize(rows * k);
+      for (size_t i = 0; i < rows; ++i)
+        for (size_t p = 0; p < k; ++p)
+          panel[i * k + p] = -t[(i0 + i) * rst + (done_begin + p) * cst];
+      gemm(rows, m, k, panel.data(), k, 1, b + done_begin * ldb, ldb, 1, b + i0 * ldb, ldb);
+    }
+
+    for (size_t step = 0; step < rows; ++step) {
+      size_t i = lower ? i0 + step : i0 + rows - 1 - step;
+      size_t from = lower ? i0 : i + 1;
+      size_t to = lower ? i : i0 + rows;
+      double *b_row = b + i * ldb;
+      for (size_t j = from; j < to; ++j) {
+        const double factor = t[i * rst + j * cst];
+        const double *b_j = b + j * ldb;
+#pragma GCC ivdep
+        for (size_t c = 0; c < m; ++c)
+          b_row[c] -= factor * b_j[c];
+      }
+      if (!unit_diagonal) {
+        const double diagonal = t[i * rst + i * cst];
+#pragma GCC ivdep
+        for (size_t c = 0; c < m; ++c)
+          b_row[c] /= diagonal;
+      }
+    }
+  }
+}
+
+void task::gemv(size_t m, size_t n, const double *a, size_t lda, const double *x, double *y) {
+  parallelForRanges(m, m * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      y[i] = vectorDot(a + i * lda, x, n);
+  });
+}
+
+void task::gevm(size_t m, size_t n, const double *x, const double *a, size_t lda, double *y) {
+  // Column parts are whole multiples of a cache line long, so threads hardly share lines of y.
+  const size_t line = ALIGNMENT / sizeof(double);
+  size_t n_lines = (n + line - 1) / line;
+  parallelForRanges(n_lines, m * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    size_t from = begin * line, to = std::min(end * line, n);
+    std::fill(y + from, y + to, 0.);
+    for (size_t i = 0; i < m; ++i)
+      vectorAxpy(y + from, x[i], a + i * lda + from, to - from);
+  });
+}
+
+void task::ger(size_t m, size_t n, double alpha, const double *x, const double *y, double *a, size_t lda) {
+  parallelForRanges(m, m * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      vectorAxpy(a + i * lda, alpha * x[i], y, n);
+  });
+}
+
+template<class T>
+void task::gemm(size_t m, size_t n, size_t k,
+                const T *a, size_t rsa, size_t csa,
+                const T *b, size_t rsb, size_t csb,
+                T *c, size_t ldc) {
+  // x87 long double has no vector registers to block for.
+  if constexpr (std::is_same<T, long double>::value)
+    gemm_small(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+  else
+    gemm_impl(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc);
+}
+
+template void task::gemm(size_t, size_t, size_t, const float *, size_t, size_t, const float *, size_t, size_t,
+                         float *, size_t);
+template void task::gemm(size_t, size_t, size_t, const long double *, size_t, size_t, const long double *,
+                         size_t, size_t, long double *, size_t);
+template void task::gemm(size_t, size_t, size_t, const int *, size_t, size_t, const int *, size_t, size_t,
+                         int *, size_t);
+template void task::gemm(size_t, size_t, size_t, const long *, size_t, size_t, const long *, size_t, size_t,
+                         long *, size_t);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+namespace task {
+
+// Register block of the micro-kernel and cache blocks of the packed panels:
+// an MR x KC sliver of A and a KC x NR sliver of B stay in L1, the packed
+// MC x KC block of A in L2 and the KC x NC panel of B in L3.
+const size_t GEMM_MR = 6;
+const size_t GEMM_NR = 8;
+const size_t GEMM_MC = 96;
+const size_t GEMM_KC = 256;
+const size_t GEMM_NC = 4096;
+
+// Products of at least GEMM_PARALLEL_CUTOFF multiply-adds by default are split into
+// GEMM_MC x GEMM_TILE_N tiles of C over defaultThreadPool(). Every element of C is
+// accumulated in the same order whatever the thread count, so results are bitwise reproducible.
+const size_t GEMM_TILE_N = 512;
+const size_t GEMM_PARALLEL_CUTOFF = 128 * 128 * 128;
+
+void setGemmParallelCutoff(size_t volume);
+size_t getGemmParallelCutoff();
+
+// C += A * B for row-major A (m x k), B (k x n) and C (m x n) with leading dimensions lda, ldb, ldc.
+void gemm(size_t m, size_t n, size_t k,
+          const double *a, size_t lda,
+          const double *b, size_t ldb,
+          double *c, size_t ldc);
+
+// The same with arbitrary row and column strides for A and B, so transposed and strided
+// views are multiplied without being copied (the packing step absorbs the strides).
+void gemm(size_t m, size_t n, size_t k,
+          const double *a, size_t rsa, size_t csa,
+          const double *b, size_t rsb, size_t csb,
+          double *c, size_t ldc);
+
+// B = T^-1 B in place for an n x n lower or upper triangular T with row and column strides rst, cst
+// (L^T is passed as L with the strides swapped) and a row-major n x m B with leading dimension ldb.
+// A unit_diagonal T has implied ones on its diagonal, like the L of an LU factorization.
+// TRSM_BLOCK rows of B are solved directly at a time; the rest of the work is one gemm per block.
+const size_t TRSM_BLOCK = 64;
+
+void trsm(bool lower, bool unit_diagonal, size_t n, size_t m,
+          const double *t, size_t rst, size_t cst,
+          double *b, size_t ldb);
+
+// Matrix-vector kernels on a row-major m x n A with leading dimension lda, built on vectorDot and
+// vectorAxpy (simd.h). From GEMV_PARALLEL_CUTOFF elements of A they are split over
+// defaultThreadPool(): gemv and ger by rows, gevm by columns, so every result has one writer.
+const size_t GEMV_PARALLEL_CUTOFF = 1 << 18;
+
+// y = A x (m results).
+void gemv(size_t m, size_t n, const double *a, size_t lda, const double *x, double *y);
+// y = x^T A (n results), accumulated row by row so A is read in storage order.
+void gevm(size_t m, size_t n, const double *x, const double *a, size_t lda, double *y);
+// A += alpha x y^T.
+void ger(size_t m, size_t n, double alpha, const double *x, const double *y, double *a, size_t lda);
+
+// Other element types (float, long double, int, long) share the blocking, with the register block
+// widened to the vector lanes of T; long double has no vector registers and takes a plain loop.
+template<class T>
+void gemm(size_t m, size_t n, size_t k,
+          const T *a, size_t rsa, size_t csa,
+          const T *b, size_t rsb, size_t csb,
+          T *c, size_t ldc);
+
+}  // namespace task
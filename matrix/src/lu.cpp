@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "lu.h"
+#include "gemm.h"
+
+using namespace task;
+
+LUDecomposition::LUDecomposition(const Matrix &a)
+    : lu(a), pivots(a.getNumRows()), odd_permutation(false), singular(false) {
+  size_t n = a.getNumRows();
+
+  if (n != a.getNumCols())
+    throw SizeMismatchException();
+
+  for (size_t k0 = 0; k0 < n; k0 += LU_BLOCK) {
+    size_t kb = std::min(LU_BLOCK, n - k0);
+    factor_panel(k0, kb);
+    update_trailing(k0, kb);
+  }
+}
+
+// Unblocked elimination restricted to columns [k0, k0 + kb); pivot rows are swapped across the
+// whole matrix, so the L columns to the left and the trailing columns follow the permutation.
+void LUDecomposition::factor_panel(size_t k0, size_t kb) {
+  size_t n = size();
+
+  for (size_t k = k0; k < k0 + kb; ++k) {
+    size_t pivot = k;
+    for (size_t i = k + 1; i < n; ++i)
+      if (std::fabs(this->lu[i][k]) > std::fabs(this->lu[pivot][k]))
+        pivot = i;
+
+    this->pivots[k] = pivot;
+    if (pivot != k) {
+      std::swap_ranges(this->lu[k], this->lu[k] + n, this->lu[pivot]);
+      this->odd_permutation = !this->odd_permutation;
+    }
+
+    const double *pivot_row = this->lu[k];
+    if (pivot_row[k] == 0.) {
+      this->singular = true;
+      continue;
+    }
+
+    for (size_t i = k + 1; i < n; ++i) {
+      double *row = this->lu[i];
+      const double factor = row[k] / pivot_row[k];
+      row[k] = factor;
+      for (size_t j = k + 1; j < k0 + kb; ++j)
+        row[j] -= factor * pivot_row[j];
+    }
+  }
+}
+
+// U12 = L11^-1 A12, then A22 -= L21 U12 as one gemm with the negated L21 panel.
+void LUDecomposition::update_trailing(size_t k0, size_t kb) {
+  size_t n = size();
+  size_t j0 = k0 + kb;
+
+  if (j0 == n)
+    return;
+
+  size_t m = n - j0;
+  size_t stride = this->lu.view().getRowStride();
+  trsm(true, true, kb, m, this->lu[k0] + k0, stride, 1, this->lu[k0] + j0, stride);
+
+  std::vector<double> panel(m * kb);
+  for (size_t i = 0; i < m; ++i)
+    for (size_t p = 0; p < kb; ++p)
+      panel[i * kb + p] = -this->lu[j0 + i][k0 + p];
+
+  gemm(m, m, kb, panel.data(), kb, this->lu[k0] + j0, stride, this->lu[j0] + j0, stride);
+}
+
+size_t LUDecomposition::size() const { return this->pivots.size(); }
+
+bool LUDecomposition::isSingular() const { return this->singular; }
+
+double LUDecomposition::det() const {
+  if (this->singular)
+    return 0.;
+
+  double det = this->odd_permutation ? -1. : 1.;
+  for (size_t i = 0; i < size(); ++i)
+    det *= this->lu[i][i];
+  return det;
+}
+
+std::vector<double> LUDecomposition::solve(const std::vector<double> &b) const {
+  if (b.size() != size())
+    throw SizeMismatchException();
+  else if (this->singular)
+    throw SingularMatrixException();
+
+  size_t n = size();
+  std::vector<double> x(b);
+
+  for (size_t k = 0; k < n; ++k)
+    std::swap(x[k], x[this->pivots[k]]);
+  for (size_t i = 1; i < n; ++i) {
+    const double *row = this->lu[i];
+    for (size_t j = 0; j < i; ++j)
+      x[i] -= row[j] * x[j];
+  }
+  for (size_t i = n; i-- > 0;) {
+    const double *row = this->lu[i];
+    for (size_t j = i + 1; j < n; ++j)
+      x[i] -= row[j] * x[j];
+    x[i] /= row[i];
+  }
+  return x;
+}
+
+Matrix LUDecomposition::solve(const Matrix &b) const {
+  if (b.getNumRows() != size())
+    throw SizeMismatchException();
+  else if (this->singular)
+    throw SingularMatrixException();
+
+  size_t n = size();
+  size_t m = b.getNumCols();
+  Matrix x(b);
+
+  for (size_t k = 0; k < n; ++k)
+    if (this->pivots[k] != k)
+      std::swap_ranges(x[k], x[k] + m, x[this->pivots[k]]);
+  size_t stride = this->lu.view().getRowStride();
+  size_t x_stride = x.view().getRowStride();
+  trsm(true, true, n, m, this->lu[0], stride, 1, x[0], x_stride);
+  trsm(false, false, n, m, this->lu[0], stride, 1, x[0], x_stride);
+  return x;
+}
+
+Matrix LUDecomposition::inverse() const { return solve(Matrix(size(), size())); }
+
+Matrix task::inverse(const Matrix &a) { return LUDecomposition(a).inverse(); }
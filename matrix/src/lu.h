@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// Columns factored per panel; the trailing submatrix is updated once per panel through gemm.
+const size_t LU_BLOCK = 64;
+
+// PA = LU with partial pivoting, computed once and reused by det() and every solve().
+// L (unit diagonal, not stored) and U share one copy of the source matrix.
+class LUDecomposition {
+ public:
+  explicit LUDecomposition(const Matrix &a);
+
+  size_t size() const;
+  bool isSingular() const;
+  double det() const;
+
+  // Solve A x = b; throw SingularMatrixException for a singular A.
+  std::vector<double> solve(const std::vector<double> &b) const;
+  Matrix solve(const Matrix &b) const;
+  Matrix inverse() const;
+
+ private:
+  Matrix lu;
+  std::vector<size_t> pivots;
+  bool odd_permutation;
+  bool singular;
+
+  void factor_panel(size_t k0, size_t kb);
+  void update_trailing(size_t k0, size_t kb);
+};
+
+// LUDecomposition(a).inverse().
+Matrix inverse(const Matrix &a);
+
+}  // namespace task
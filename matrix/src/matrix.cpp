@@ -1,326 +1,801 @@
+#include <algorithm>
 #include <cmath>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "matrix.h"
+#include "buffer_pool.h"
+#include "gemm.h"
+#include "lu.h"
+#include "matrix_stats.h"
+#include "simd.h"
+#include "strassen.h"
 
 using namespace task;
 
-double **Matrix::init_zero_matrix(size_t rows, size_t cols) {
-  double **matrix;
+namespace {
+
+// Gaussian elimination with partial pivoting for the floating types other than double.
+template<class T>
+T det_elimination(BasicMatrix<T> a) {
+  size_t n = a.getNumRows();
+  T det = 1;
+
+  for (size_t k = 0; k < n; ++k) {
+    size_t pivot = k;
+    for (size_t i = k + 1; i < n; ++i)
+      if (std::fabs(a[i][k]) > std::fabs(a[pivot][k]))
+        pivot = i;
+    if (a[pivot][k] == 0)
+      return 0;
+    if (pivot != k) {
+      std::swap_ranges(a[k], a[k] + n, a[pivot]);
+      det = -det;
+    }
 
-  if (rows == 0 or cols == 0)
-    throw OutOfBoundsException();
-  else {
-    matrix = new double *[rows];
+    det *= a[k][k];
+    for (size_t i = k + 1; i < n; ++i) {
+      const T factor = a[i][k] / a[k][k];
+      for (size_t j = k + 1; j < n; ++j)
+        a[i][j] -= factor * a[k][j];
+    }
+  }
+  return det;
+}
 
-    for (size_t i = 0; i < rows; ++i) {
-      matrix[i] = new double[cols];
-      for (size_t j = 0; j < cols; ++j)
-        matrix[i][j] = 0.;
+// Bareiss fraction-free elimination: every intermediate entry is a minor of the input and every
+// division is exact, so integer determinants are exact whenever those minors fit in T.
+template<class T>
+T det_bareiss(BasicMatrix<T> a) {
+  size_t n = a.getNumRows();
+  T sign = 1, previous = 1;
+
+  for (size_t k = 0; k + 1 < n; ++k) {
+    if (a[k][k] == 0) {
+      size_t pivot = k + 1;
+      while (pivot < n and a[pivot][k] == 0)
+        ++pivot;
+      if (pivot == n)
+        return 0;
+      std::swap_ranges(a[k], a[k] + n, a[pivot]);
+      sign = -sign;
     }
-    return matrix;
+
+    for (size_t i = k + 1; i < n; ++i)
+      for (size_t j = k + 1; j < n; ++j)
+        a[i][j] = (a[i][j] * a[k][k] - a[i][k] * a[k][j]) / previous;
+    previous = a[k][k];
+  }
+  return sign * a[n - 1][n - 1];
+}
+
+// x^k by repeated squaring, rounding like the matrix power it stands in for.
+template<class T>
+T scalar_pow(T x, uint64_t k) {
+  T result = 1;
+
+  for (; k != 0; k >>= 1) {
+    if (k & 1)
+      result *= x;
+    if (k > 1)
+      x *= x;
   }
+  return result;
 }
 
-void Matrix::matrix_copy(double **from, double **to, size_t rows, size_t cols) {
+// Plugs a pool of its own into the calling thread for its lifetime, unless one is plugged in already.
+class ScopedBufferPool {
+ public:
+  ScopedBufferPool() : plugged(getThreadBufferPool() == nullptr) {
+    if (this->plugged)
+      setThreadBufferPool(&this->pool);
+  }
+  ScopedBufferPool(const ScopedBufferPool &) = delete;
+  ScopedBufferPool &operator=(const ScopedBufferPool &) = delete;
+  ~ScopedBufferPool() {
+    if (this->plugged)
+      setThreadBufferPool(nullptr);
+  }
+
+ private:
+  MatrixBufferPool pool;
+  bool plugged;
+};
+
+}  // namespace
+
+template<class T>
+size_t BasicMatrix<T>::aligned_stride(size_t cols) {
+  const size_t line = ALIGNMENT / sizeof(T);
+
+  if (cols < line)
+    return cols;
+  else
+    return (cols + line - 1) / line * line;
+}
+
+template<class T>
+struct BasicMatrix<T>::BufferHeader {
+  std::atomic<size_t> uses;
+  // Bytes of the whole block, header included.
+  size_t size;
+};
+
+template<class T>
+typename BasicMatrix<T>::BufferHeader &BasicMatrix<T>::header(T *ptr) {
+  return *reinterpret_cast<BufferHeader *>(reinterpret_cast<char *>(ptr) - ALIGNMENT);
+}
+
+template<class T>
+T *BasicMatrix<T>::alloc_buffer(size_t elements, bool exact) {
+  static_assert(sizeof(BufferHeader) <= ALIGNMENT, "the buffer header must fit before the elements");
+
+  size_t size;
+  char *block = static_cast<char *>(allocateBuffer(ALIGNMENT + elements * sizeof(T), size, exact));
+  new(block) BufferHeader{{1}, size};
+  recordMatrixAllocation(size);
+  return reinterpret_cast<T *>(block + ALIGNMENT);
+}
+
+template<class T>
+T *BasicMatrix<T>::init_matrix(size_t rows, size_t stride) {
+  if (rows == 0 or stride == 0)
+    throw OutOfBoundsException();
+  else if (rows * stride <= MATRIX_INLINE_ELEMENTS)
+    return this->inline_values;
+  else
+    return alloc_buffer(rows * stride, false);
+}
+
+template<class T>
+T *BasicMatrix<T>::init_zero_matrix(size_t rows, size_t stride) {
+  T *matrix = init_matrix(rows, stride);
+
+  std::fill(matrix, matrix + rows * stride, T(0));
+  return matrix;
+}
+
+template<class T>
+void BasicMatrix<T>::matrix_copy(const T *from, size_t from_stride, T *to, size_t to_stride,
+                         size_t rows, size_t cols) {
   for (size_t i = 0; i < rows; ++i)
-    for (size_t j = 0; j < cols; ++j)
-      to[i][j] = from[i][j];
+    std::copy(from + i * from_stride, from + i * from_stride + cols, to + i * to_stride);
 }
 
-void Matrix::free_matrix(double **ptr, size_t size) {
-  for (size_t i = 0; i < size; ++i)
-    delete[] ptr[i];
-  delete[] ptr;
+// The last owner of a heap buffer hands it back to releaseBuffer.
+template<class T>
+void BasicMatrix<T>::free_matrix() {
+  T *ptr = this->mat_values;
+  if (ptr == nullptr or is_inline() or header(ptr).uses.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+
+  size_t size = header(ptr).size;
+  header(ptr).~BufferHeader();
+  releaseBuffer(reinterpret_cast<char *>(ptr) - ALIGNMENT, size);
 }
 
-Matrix::Matrix() : n_rows(1), n_cols(1), mat_values(init_zero_matrix(1, 1)) { this->mat_values[0][0] = 1.0; }
+// Cache-oblivious transposes: halve the longer side until a block fits in L1.
+template<class T>
+void BasicMatrix<T>::transpose_copy(const T *from, size_t from_stride, T *to, size_t to_stride,
+                            size_t rows, size_t cols) {
+  if (rows <= TRANSPOSE_BLOCK and cols <= TRANSPOSE_BLOCK) {
+    for (size_t i = 0; i < rows; ++i)
+      for (size_t j = 0; j < cols; ++j)
+        to[j * to_stride + i] = from[i * from_stride + j];
+  } else if (rows >= cols) {
+    size_t half = rows / 2;
+    transpose_copy(from, from_stride, to, to_stride, half, cols);
+    transpose_copy(from + half * from_stride, from_stride, to + half, to_stride, rows - half, cols);
+  } else {
+    size_t half = cols / 2;
+    transpose_copy(from, from_stride, to, to_stride, rows, half);
+    transpose_copy(from + half, from_stride, to + half * to_stride, to_stride, rows, cols - half);
+  }
+}
 
-Matrix::Matrix(size_t rows, size_t cols) : n_rows(rows), n_cols(cols), mat_values(init_zero_matrix(rows, cols)) {
+// Exchanges the rows x cols block at a with the transpose of the cols x rows block at b.
+template<class T>
+void BasicMatrix<T>::transpose_swap(T *a, T *b, size_t stride, size_t rows, size_t cols) {
+  if (rows <= TRANSPOSE_BLOCK and cols <= TRANSPOSE_BLOCK) {
+    for (size_t i = 0; i < rows; ++i)
+      for (size_t j = 0; j < cols; ++j)
+        std::swap(a[i * stride + j], b[j * stride + i]);
+  } else if (rows >= cols) {
+    size_t half = rows / 2;
+    transpose_swap(a, b, stride, half, cols);
+    transpose_swap(a + half * stride, b + half, stride, rows - half, cols);
+  } else {
+    size_t half = cols / 2;
+    transpose_swap(a, b, stride, rows, half);
+    transpose_swap(a + half, b + half * stride, stride, rows, cols - half);
+  }
+}
+
+template<class T>
+void BasicMatrix<T>::transpose_square(T *values, size_t size, size_t stride) {
+  if (size <= TRANSPOSE_BLOCK) {
+    for (size_t i = 0; i < size; ++i)
+      for (size_t j = i + 1; j < size; ++j)
+        std::swap(values[i * stride + j], values[j * stride + i]);
+  } else {
+    size_t half = size / 2;
+    transpose_square(values, half, stride);
+    transpose_square(values + half * stride + half, size - half, stride);
+    transpose_swap(values + half, values + half * stride, stride, half, size - half);
+  }
+}
+
+// In-place transpose of a dense rows x cols array by following the cycles of the permutation
+// k -> k * rows mod (rows * cols - 1). The elements never leave the array, but the positions
+// already placed are marked in a std::vector<bool> on the side: rows * cols bits, so the one
+// allocation is 1/64 of the matrix for double.
+template<class T>
+void BasicMatrix<T>::transpose_dense(T *values, size_t rows, size_t cols) {
+  size_t last = rows * cols - 1;
+  std::vector<bool> moved(last + 1);
+
+  for (size_t start = 1; start < last; ++start) {
+    if (moved[start])
+      continue;
+    T carried = values[start];
+    size_t pos = start;
+    do {
+      pos = pos * rows % last;
+      std::swap(carried, values[pos]);
+      moved[pos] = true;
+    } while (pos != start);
+  }
+}
+
+template<class T>
+BasicMatrix<T>::BasicMatrix()
+    : n_rows(1), n_cols(1), row_stride(aligned_stride(1)), mat_values(init_zero_matrix(1, row_stride)) {
+  this->mat_values[0] = T(1);
+}
+
+template<class T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols)
+    : n_rows(rows), n_cols(cols), row_stride(aligned_stride(cols)), mat_values(init_zero_matrix(rows, row_stride)) {
   for (size_t i = 0; i < std::min(this->n_rows, this->n_cols); ++i)
-    this->mat_values[i][i] = 1.0;
+    this->mat_values[i * this->row_stride + i] = T(1);
 }
 
-Matrix::Matrix(const Matrix &copy) {
-  this->n_rows = copy.n_rows;
-  this->n_cols = copy.n_cols;
-  this->mat_values = init_zero_matrix(this->n_rows, this->n_cols);
-  matrix_copy(copy.mat_values, this->mat_values, this->n_rows, this->n_cols);
+template<class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix<T> &copy)
+    : n_rows(copy.n_rows), n_cols(copy.n_cols), row_stride(copy.row_stride), mat_values(copy.mat_values) {
+  MatrixOpScope scope(MatrixOp::COPY, 0);
+  if (copy.is_inline()) {
+    std::copy(copy.inline_values, copy.inline_values + this->n_rows * this->row_stride, this->inline_values);
+    this->mat_values = this->inline_values;
+  } else if (this->mat_values != nullptr)
+    header(this->mat_values).uses.fetch_add(1, std::memory_order_relaxed);
 }
 
-Matrix::~Matrix() { free_matrix(this->mat_values, this->n_rows); }
+template<class T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix<T> &&other) noexcept : mat_values(nullptr) { take_storage(other); }
 
-Matrix &Matrix::operator=(const Matrix &a) {
-  if (this != &a) {
-    free_matrix(this->mat_values, this->n_rows);
+template<class T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols, size_t stride)
+    : n_rows(rows), n_cols(cols), row_stride(stride), mat_values(init_matrix(rows, stride)) {}
+
+template<class T>
+BasicMatrix<T>::~BasicMatrix() { free_matrix(); }
+
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const BasicMatrix<T> &a) {
+  if (this->mat_values != a.mat_values)
+    *this = BasicMatrix(a);
+  else {
     this->n_rows = a.n_rows;
     this->n_cols = a.n_cols;
-    this->mat_values = init_zero_matrix(a.n_rows, a.n_cols);
-    matrix_copy(a.mat_values, this->mat_values, this->n_rows, this->n_cols);
+    this->row_stride = a.row_stride;
+  }
+  return *this;
+}
+
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator=(BasicMatrix<T> &&a) noexcept {
+  if (this != &a) {
+    free_matrix();
+    take_storage(a);
   }
   return *this;
 }
 
-double &Matrix::get(size_t row, size_t col) {
+// Takes the shape and elements of other, which is left empty; this matrix holds no buffer.
+template<class T>
+void BasicMatrix<T>::take_storage(BasicMatrix<T> &other) noexcept {
+  this->n_rows = other.n_rows;
+  this->n_cols = other.n_cols;
+  this->row_stride = other.row_stride;
+  if (other.is_inline()) {
+    std::copy(other.inline_values, other.inline_values + this->n_rows * this->row_stride, this->inline_values);
+    this->mat_values = this->inline_values;
+  } else
+    this->mat_values = other.mat_values;
+
+  other.n_rows = other.n_cols = other.row_stride = 0;
+  other.mat_values = nullptr;
+}
+
+template<class T>
+bool BasicMatrix<T>::is_shared() const {
+  return this->mat_values != nullptr and !is_inline()
+      and header(this->mat_values).uses.load(std::memory_order_acquire) != 1;
+}
+
+template<class T>
+void BasicMatrix<T>::detach() {
+  if (is_shared()) {
+    MatrixOpScope scope(MatrixOp::DETACH, 0);
+    reallocate(this->n_rows * this->row_stride, false);
+  }
+}
+
+// Moves the elements of the current shape into the inline storage when the given capacity fits it,
+// otherwise into a new heap buffer of that capacity.
+template<class T>
+void BasicMatrix<T>::reallocate(size_t elements, bool exact) {
+  bool fits_inline = elements <= MATRIX_INLINE_ELEMENTS;
+  if (fits_inline and is_inline())
+    return;
+
+  T *new_values = fits_inline ? this->inline_values : alloc_buffer(elements, exact);
+  std::copy(this->mat_values, this->mat_values + this->n_rows * this->row_stride, new_values);
+  free_matrix();
+  this->mat_values = new_values;
+}
+
+template<class T>
+T &BasicMatrix<T>::get(size_t row, size_t col) {
   if (row >= this->n_rows or col >= this->n_cols)
     throw OutOfBoundsException();
-  else
-    return this->mat_values[row][col];
+
+  detach();
+  return this->mat_values[row * this->row_stride + col];
 }
 
-const double &Matrix::get(size_t row, size_t col) const {
+template<class T>
+const T &BasicMatrix<T>::get(size_t row, size_t col) const {
   if (row >= this->n_rows or col >= this->n_cols)
     throw OutOfBoundsException();
   else
-    return this->mat_values[row][col];
+    return this->mat_values[row * this->row_stride + col];
 }
 
-void Matrix::set(size_t row, size_t col, const double &value) {
+template<class T>
+void BasicMatrix<T>::set(size_t row, size_t col, const T &value) {
   if (row >= this->n_rows or col >= this->n_cols)
     throw OutOfBoundsException();
-  else
-    this->mat_values[row][col] = value;
+
+  detach();
+  this->mat_values[row * this->row_stride + col] = value;
 }
 
-void Matrix::resize(size_t new_rows, size_t new_cols) {
-  double **new_values = init_zero_matrix(new_rows, new_cols);
+template<class T>
+void BasicMatrix<T>::resize(size_t new_rows, size_t new_cols) {
+  MatrixOpScope scope(MatrixOp::RESIZE, 0);
+  size_t new_stride = aligned_stride(new_cols);
   size_t rows = std::min(new_rows, this->n_rows);
   size_t cols = std::min(new_cols, this->n_cols);
 
-  matrix_copy(this->mat_values, new_values, rows, cols);
-  free_matrix(this->mat_values, this->n_rows);
+  if (new_rows == 0 or new_stride == 0)
+    throw OutOfBoundsException();
+  if (this->mat_values == nullptr or is_shared() or new_rows * new_stride > capacity()) {
+    T *new_values = init_zero_matrix(new_rows, new_stride);
+    matrix_copy(this->mat_values, this->row_stride, new_values, new_stride, rows, cols);
+    free_matrix();
+    this->mat_values = new_values;
+  } else {
+    // Rows move towards the end of the buffer when the stride grows and towards its start when it
+    // shrinks, so walking them last-first or first-last never overwrites a row not yet moved.
+    T *values = this->mat_values;
+    for (size_t step = 0; step < rows; ++step) {
+      size_t i = new_stride > this->row_stride ? rows - 1 - step : step;
+      const T *from = values + i * this->row_stride;
+      T *to = values + i * new_stride;
+      if (new_stride > this->row_stride)
+        std::copy_backward(from, from + cols, to + cols);
+      else if (new_stride < this->row_stride)
+        std::copy(from, from + cols, to);
+      std::fill(to + cols, to + new_cols, T(0));
+    }
+    std::fill(values + rows * new_stride, values + new_rows * new_stride, T(0));
+  }
 
   this->n_rows = new_rows;
   this->n_cols = new_cols;
-  this->mat_values = new_values;
+  this->row_stride = new_stride;
 }
 
-double *Matrix::operator[](size_t row) { return this->mat_values[row]; }
+template<class T>
+size_t BasicMatrix<T>::capacity() const {
+  if (this->mat_values == nullptr)
+    return 0;
+  else if (is_inline())
+    return MATRIX_INLINE_ELEMENTS;
+  else
+    return (header(this->mat_values).size - ALIGNMENT) / sizeof(T);
+}
+
+template<class T>
+void BasicMatrix<T>::reserve(size_t elements) {
+  if (this->mat_values != nullptr and elements > capacity())
+    reallocate(elements, false);
+}
+
+template<class T>
+void BasicMatrix<T>::shrinkToFit() {
+  if (this->mat_values != nullptr and capacity() > this->n_rows * this->row_stride)
+    reallocate(this->n_rows * this->row_stride, true);
+}
+
+template<class T>
+T *BasicMatrix<T>::operator[](size_t row) {
+  detach();
+  return this->mat_values + row * this->row_stride;
+}
 
-double *Matrix::operator[](size_t row) const { return this->mat_values[row]; }
+template<class T>
+T *BasicMatrix<T>::operator[](size_t row) const { return this->mat_values + row * this->row_stride; }
 
-Matrix &Matrix::operator+=(const Matrix &a) {
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix<T> &a) {
   if (a.n_rows != this->n_rows or a.n_cols != this->n_cols)
     throw SizeMismatchException();
   else {
+    detach();
     for (size_t i = 0; i < this->n_rows; ++i)
-      for (size_t j = 0; j < this->n_cols; ++j)
-        this->mat_values[i][j] += a.mat_values[i][j];
+      vectorAdd(this->mat_values + i * this->row_stride, a.mat_values + i * a.row_stride, this->n_cols);
     return *this;
   }
 }
 
-Matrix &Matrix::operator-=(const Matrix &a) {
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const BasicMatrix<T> &a) {
   if (a.n_rows != this->n_rows or a.n_cols != this->n_cols)
     throw SizeMismatchException();
   else {
+    detach();
     for (size_t i = 0; i < this->n_rows; ++i)
-      for (size_t j = 0; j < this->n_cols; ++j)
-        this->mat_values[i][j] -= a.mat_values[i][j];
+      vectorSub(this->mat_values + i * this->row_stride, a.mat_values + i * a.row_stride, this->n_cols);
     return *this;
   }
 }
 
-Matrix &Matrix::operator*=(const Matrix &a) {
-  if (this->n_cols != a.n_rows)
-    throw SizeMismatchException();
-  else {
-    double **res_values = init_zero_matrix(this->n_rows, a.n_cols);
-
-    for (size_t i = 0; i < this->n_rows; ++i)
-      for (size_t j = 0; j < a.n_cols; ++j)
-        for (size_t k = 0; k < a.n_rows; ++k)
-          res_values[i][j] += this->mat_values[i][k] * a.mat_values[k][j];
-
-    free_matrix(this->mat_values, this->n_rows);
-    this->n_cols = a.n_cols;
-    this->mat_values = res_values;
-
-    return *this;
-  }
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(const BasicMatrix<T> &a) {
+  MatrixOpScope scope(MatrixOp::MULTIPLY_ASSIGN, uint64_t(2) * this->n_rows * this->n_cols * a.n_cols);
+  *this = *this * a;
+  return *this;
 }
 
-Matrix &Matrix::operator*=(const double &number) {
+template<class T>
+BasicMatrix<T> &BasicMatrix<T>::operator*=(const T &number) {
+  detach();
   for (size_t i = 0; i < this->n_rows; ++i)
-    for (size_t j = 0; j < this->n_cols; ++j)
-      this->mat_values[i][j] *= number;
+    vectorScale(this->mat_values + i * this->row_stride, number, this->n_cols);
   return *this;
 }
 
-Matrix Matrix::operator+(const Matrix &a) const {
-  Matrix new_mat(*this);
-  new_mat += a;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::multiply(const BasicMatrixView<T> &a, const BasicMatrixView<T> &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+  else {
+    // Opened before the result is allocated, so its buffer is charged to the product.
+    MatrixOpScope scope(MatrixOp::MULTIPLY, uint64_t(2) * a.getNumRows() * b.getNumCols() * a.getNumCols());
+    size_t res_stride = aligned_stride(b.getNumCols());
+    BasicMatrix<T> new_mat(a.getNumRows(), b.getNumCols(), res_stride);
 
-  return new_mat;
+    multiply_into(a, b, new_mat.mat_values, res_stride);
+    return new_mat;
+  }
 }
 
-Matrix Matrix::operator-(const Matrix &a) const {
-  Matrix new_mat(*this);
-  new_mat -= a;
+template<class T>
+void BasicMatrix<T>::multiply_into(const BasicMatrixView<T> &a, const BasicMatrixView<T> &b, T *c, size_t ldc) {
+  size_t m = a.getNumRows(), n = b.getNumCols(), k = a.getNumCols();
 
-  return new_mat;
+  for (size_t i = 0; i < m; ++i)
+    std::fill(c + i * ldc, c + i * ldc + n, T(0));
+  if constexpr (std::is_same<T, double>::value) {
+    if (isStrassenEnabled() and a.getColStride() == 1 and b.getColStride() == 1) {
+      strassen(m, n, k, a.data(), a.getRowStride(), b.data(), b.getRowStride(), c, ldc);
+      return;
+    }
+  }
+  gemm(m, n, k, a.data(), a.getRowStride(), a.getColStride(), b.data(), b.getRowStride(), b.getColStride(),
+       c, ldc);
 }
 
-Matrix Matrix::operator*(const Matrix &a) const {
-  Matrix new_mat(*this);
-  new_mat *= a;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const T &a) && {
+  *this *= a;
 
-  return new_mat;
+  return std::move(*this);
 }
 
-Matrix Matrix::operator*(const double &a) const {
-  Matrix new_mat(*this);
-  new_mat *= a;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator-() && {
+  *this *= T(-1);
 
-  return new_mat;
+  return std::move(*this);
 }
 
-Matrix Matrix::operator-() const {
-  Matrix new_mat(*this);
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator+() const & {
+  BasicMatrix<T> new_mat(*this);
 
-  new_mat *= -1.;
   return new_mat;
 }
 
-Matrix Matrix::operator+() const {
-  Matrix new_mat(*this);
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator+() && { return std::move(*this); }
 
-  return new_mat;
-}
-
-double Matrix::det() const {
+template<class T>
+T BasicMatrix<T>::det() const {
   if (this->n_rows != this->n_cols)
     throw SizeMismatchException();
   else {
+    const BasicMatrix<T> &self = *this;
+    MatrixOpScope scope(MatrixOp::DET, uint64_t(2) * this->n_rows * this->n_rows * this->n_rows / 3);
+
     if (this->n_rows == 1)
-      return this->mat_values[0][0];
+      return self[0][0];
     else if (this->n_rows == 2)
-      return this->mat_values[0][0] * this->mat_values[1][1] - this->mat_values[0][1] * this->mat_values[1][0];
-    else {
-      double result = 0.0;
-
-      for (size_t k = 0; k < this->n_rows; ++k) {
-        Matrix small_matrix(this->n_rows - 1, this->n_rows - 1);
-        for (size_t i = 1; i < this->n_rows; ++i) {
-          for (size_t j = 0; j < this->n_rows; ++j) {
-            if (j == k)
-              continue;
-            else if (j < k)
-              small_matrix[i - 1][j] = this->mat_values[i][j];
-            else
-              small_matrix[i - 1][j - 1] = this->mat_values[i][j];
-          }
-        }
-        result += ((k % 2 == 0) ? 1 : -1) * this->mat_values[0][k] * small_matrix.det();
+      return self[0][0] * self[1][1] - self[0][1] * self[1][0];
+    else if constexpr (std::is_integral<T>::value)
+      return det_bareiss(self);
+    else if constexpr (std::is_same<T, double>::value)
+      return LUDecomposition(self).det();
+    else
+      return det_elimination(self);
+  }
+}
+
+template<class T>
+bool BasicMatrix<T>::is_diagonal() const {
+  for (size_t i = 0; i < this->n_rows; ++i)
+    for (size_t j = 0; j < this->n_cols; ++j)
+      if (i != j and this->mat_values[i * this->row_stride + j] != T(0))
+        return false;
+  return true;
+}
+
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::pow(uint64_t k) const {
+  if (this->n_rows != this->n_cols)
+    throw SizeMismatchException();
+
+  // One squaring per bit below the highest and one product per set bit below it.
+  size_t n = this->n_rows;
+  bool diagonal = k > 1 and is_diagonal();
+  uint64_t products = 0;
+  for (uint64_t bits = diagonal ? 0 : k; bits > 1; bits >>= 1)
+    products += 1 + (bits & 1);
+  MatrixOpScope scope(MatrixOp::POW, products * 2 * n * n * n);
+
+  if (k == 0)
+    return BasicMatrix<T>(n, n);
+  if (k == 1)
+    return *this;
+  if (diagonal) {
+    BasicMatrix<T> result(*this);
+    for (size_t i = 0; i < n; ++i)
+      result[i][i] = scalar_pow(result[i][i], k);
+    return result;
+  }
+
+  // base holds A^(2^bit); result takes the powers of the set bits, the first one copied rather than
+  // multiplied by the identity. Every product goes to scratch, which then swaps with its target.
+  size_t stride = aligned_stride(n);
+  BasicMatrix<T> base(n, n, stride), result(n, n, stride), scratch(n, n, stride);
+  matrix_copy(this->mat_values, this->row_stride, base.mat_values, stride, n, n);
+  // Hands gemm's pack panels from one product to the next; it is unplugged before the matrices
+  // above are released, so they go back where they came from.
+  ScopedBufferPool panels;
+  // Every product counts as a MULTIPLY too, like the one inside operator*=.
+  auto square_product = [&](const BasicMatrix<T> &a, const BasicMatrix<T> &b) {
+    MatrixOpScope product(MatrixOp::MULTIPLY, uint64_t(2) * n * n * n);
+    multiply_into(a.view(), b.view(), scratch.mat_values, stride);
+  };
+  bool started = false;
+  for (;;) {
+    if (k & 1) {
+      if (started) {
+        square_product(result, base);
+        std::swap(result, scratch);
+      } else {
+        std::copy(base.mat_values, base.mat_values + n * stride, result.mat_values);
+        started = true;
       }
-      return result;
     }
+    k >>= 1;
+    if (k == 0)
+      return result;
+    square_product(base, base);
+    std::swap(base, scratch);
   }
 }
 
-void Matrix::transpose() {
-  double **new_values = init_zero_matrix(this->n_cols, this->n_rows);
+template<class T>
+void BasicMatrix<T>::transpose() {
+  MatrixOpScope scope(MatrixOp::TRANSPOSE, 0);
+  detach();
+  if (this->n_rows == this->n_cols) {
+    transpose_square(this->mat_values, this->n_rows, this->row_stride);
+    return;
+  }
 
-  for (size_t i = 0; i < this->n_rows; ++i)
-    for (size_t j = 0; j < this->n_cols; ++j)
-      new_values[j][i] = this->mat_values[i][j];
-  free_matrix(this->mat_values, this->n_rows);
-  std::swap(this->n_rows, this->n_cols);
-  this->mat_values = new_values;
+  size_t rows = this->n_rows, cols = this->n_cols;
+  size_t capacity = rows * this->row_stride;
+  size_t new_stride = aligned_stride(rows);
+  if (cols * new_stride > capacity)
+    new_stride = rows;
+
+  for (size_t i = 1; i < rows; ++i)
+    std::copy(this->mat_values + i * this->row_stride, this->mat_values + i * this->row_stride + cols,
+              this->mat_values + i * cols);
+  transpose_dense(this->mat_values, rows, cols);
+  for (size_t i = cols; new_stride != rows and i-- > 1;)
+    std::copy_backward(this->mat_values + i * rows, this->mat_values + (i + 1) * rows,
+                       this->mat_values + i * new_stride + rows);
+
+  this->n_rows = cols;
+  this->n_cols = rows;
+  this->row_stride = new_stride;
 }
 
-Matrix Matrix::transposed() const {
-  Matrix new_mat(*this);
-  new_mat.transpose();
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::transposed() const & {
+  MatrixOpScope scope(MatrixOp::TRANSPOSE, 0);
+  size_t new_stride = aligned_stride(this->n_rows);
+  BasicMatrix<T> new_mat(this->n_cols, this->n_rows, new_stride);
 
+  transpose_copy(this->mat_values, this->row_stride, new_mat.mat_values, new_stride, this->n_rows, this->n_cols);
   return new_mat;
 }
 
-double Matrix::trace() const {
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::transposed() && {
+  transpose();
+
+  return std::move(*this);
+}
+
+template<class T>
+T BasicMatrix<T>::trace() const {
   if (this->n_rows != this->n_cols)
     throw SizeMismatchException();
   else {
-    double trace = 0.0;
+    T trace = 0;
 
     for (size_t i = 0; i < this->n_rows; ++i)
-      trace += this->mat_values[i][i];
+      trace += this->mat_values[i * this->row_stride + i];
 
     return trace;
   }
 }
 
-std::vector<double> Matrix::getRow(size_t row) {
+template<class T>
+std::vector<T> BasicMatrix<T>::getRow(size_t row) {
   if (row >= this->n_rows)
     throw OutOfBoundsException();
   else {
-    std::vector<double> row_vec(this->n_cols);
-
-    for (size_t i = 0; i < this->n_cols; ++i)
-      row_vec[i] = this->mat_values[row][i];
+    const T *row_begin = this->mat_values + row * this->row_stride;
 
-    return row_vec;
+    return std::vector<T>(row_begin, row_begin + this->n_cols);
   }
 }
 
-std::vector<double> Matrix::getColumn(size_t column) {
+template<class T>
+std::vector<T> BasicMatrix<T>::getColumn(size_t column) {
   if (column >= this->n_cols)
     throw OutOfBoundsException();
   else {
-    std::vector<double> col_vec(this->n_rows);
+    std::vector<T> col_vec(this->n_rows);
 
     for (size_t j = 0; j < this->n_rows; ++j)
-      col_vec[j] = this->mat_values[column][j];
+      col_vec[j] = this->mat_values[j * this->row_stride + column];
 
     return col_vec;
   }
 }
 
-bool Matrix::operator==(const Matrix &a) const {
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::view() const {
+  return BasicMatrixView<T>(this->mat_values, this->n_rows, this->n_cols, this->row_stride, 1);
+}
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::transposedView() const { return view().transposedView(); }
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::row(size_t row) const { return view().row(row); }
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::column(size_t column) const { return view().column(column); }
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::block(size_t row, size_t col, size_t rows, size_t cols) const {
+  return view().block(row, col, rows, cols);
+}
+
+template<class T>
+bool BasicMatrix<T>::operator==(const BasicMatrix<T> &a) const {
   if (this->n_cols != a.n_cols or this->n_rows != a.n_rows)
     return false;
   for (size_t i = 0; i < this->n_rows; ++i)
-    for (size_t j = 0; j < this->n_cols; ++j)
-      if (fabs(this->mat_values[i][j] - a.mat_values[i][j]) > EPS)
-        return false;
+    if (!vectorEqual(this->mat_values + i * this->row_stride, a.mat_values + i * a.row_stride, this->n_cols,
+                     MatrixTraits<T>::eps()))
+      return false;
   return true;
 }
 
-bool Matrix::operator!=(const Matrix &a) const { return !(*this == a); }
+template<class T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix<T> &a) const { return !(*this == a); }
 
-size_t Matrix::getNumRows() const { return this->n_rows; }
+template<class T>
+size_t BasicMatrix<T>::getNumRows() const { return this->n_rows; }
 
-size_t Matrix::getNumCols() const { return this->n_cols; }
+template<class T>
+size_t BasicMatrix<T>::getNumCols() const { return this->n_cols; }
 
-Matrix task::operator*(const double &a, const Matrix &b) {
-  Matrix new_mat(b);
-  new_mat *= a;
+template<class T>
+BasicMatrix<T> task::operator+(BasicMatrix<T> &&a, BasicMatrix<T> &&b) { return std::move(a) + b; }
 
-  return new_mat;
-}
+template<class T>
+BasicMatrix<T> task::operator-(BasicMatrix<T> &&a, BasicMatrix<T> &&b) { return std::move(a) - b; }
 
-std::ostream &task::operator<<(std::ostream &output, const Matrix &matrix) {
-  size_t n_rows = matrix.getNumRows();
-  size_t n_cols = matrix.getNumCols();
+template<class T>
+BasicMatrix<T> task::operator*(const typename BasicMatrix<T>::value_type &a, BasicMatrix<T> &&b) {
+  return std::move(b) * a;
+}
 
-  for (size_t i = 0; i < n_rows; ++i) {
-    for (size_t j = 0; j < n_cols; ++j)
-      output << matrix[i][j] << ' ';
-    output << std::endl;
-  }
-  return output;
+std::vector<double> task::operator*(const Matrix &a, const std::vector<double> &x) {
+  std::vector<double> y;
+  multiply(a, x, y);
+  return y;
 }
 
-std::istream &task::operator>>(std::istream &input, Matrix &matrix) {
-  size_t n_rows, n_cols;
-  input >> n_rows >> n_cols;
+std::vector<double> task::operator*(const std::vector<double> &x, const Matrix &a) {
+  std::vector<double> y;
+  multiply(x, a, y);
+  return y;
+}
 
-  matrix.resize(n_rows, n_cols);
-  for (size_t i = 0; i < n_rows; ++i)
-    for (size_t j = 0; j < n_cols; ++j)
-      input >> matrix[i][j];
+void task::multiply(const Matrix &a, const std::vector<double> &x, std::vector<double> &y) {
+  if (x.size() != a.getNumCols())
+    throw SizeMismatchException();
 
-  return input;
+  y.resize(a.getNumRows());
+  gemv(a.getNumRows(), a.getNumCols(), a[0], a.view().getRowStride(), x.data(), y.data());
 }
 
+void task::multiply(const std::vector<double> &x, const Matrix &a, std::vector<double> &y) {
+  if (x.size() != a.getNumRows())
+    throw SizeMismatchException();
 
+  y.resize(a.getNumCols());
+  gevm(a.getNumRows(), a.getNumCols(), x.data(), a[0], a.view().getRowStride(), y.data());
+}
 
+void task::rankOneUpdate(Matrix &a, double alpha, const std::vector<double> &x, const std::vector<double> &y) {
+  if (x.size() != a.getNumRows() or y.size() != a.getNumCols())
+    throw SizeMismatchException();
 
+  ger(a.getNumRows(), a.getNumCols(), alpha, x.data(), y.data(), a[0], a.view().getRowStride());
+}
 
+#define TASK_INSTANTIATE_MATRIX(T)                                                      \
+  template class task::BasicMatrix<T>;                                                  \
+  template BasicMatrix<T> task::operator+(BasicMatrix<T> &&a, BasicMatrix<T> &&b);      \
+  template BasicMatrix<T> task::operator-(BasicMatrix<T> &&a, BasicMatrix<T> &&b);      \
+  template BasicMatrix<T> task::operator*(const T &a, BasicMatrix<T> &&b);
+
+TASK_INSTANTIATE_MATRIX(float)
+TASK_INSTANTIATE_MATRIX(double)
+TASK_INSTANTIATE_MATRIX(long double)
+TASK_INSTANTIATE_MATRIX(int)
+TASK_INSTANTIATE_MATRIX(long)
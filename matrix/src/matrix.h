@@ -1,72 +1,256 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <iostream>
+#include <type_traits>
 
 namespace task {
 
-const double EPS = 1e-6;
+constexpr double EPS = 1e-6;
+// float carries about 7 significant digits, so == allows a coarser per-element difference.
+const float FLOAT_EPS = 1e-4f;
+const size_t ALIGNMENT = 64;
+const size_t TRANSPOSE_BLOCK = 32;
+
+// Matrices of at most MATRIX_INLINE_ELEMENTS elements, row padding included, keep them inside the
+// object instead of a heap buffer; build every source with -DTASK_MATRIX_INLINE_ELEMENTS=n to change
+// the limit, 0 turns it off.
+#ifndef TASK_MATRIX_INLINE_ELEMENTS
+#define TASK_MATRIX_INLINE_ELEMENTS 16
+#endif
+const size_t MATRIX_INLINE_ELEMENTS = TASK_MATRIX_INLINE_ELEMENTS;
 
 class OutOfBoundsException : public std::exception {};
 class SizeMismatchException : public std::exception {};
+class SingularMatrixException : public std::exception {};
+
+template<class T>
+class BasicMatrix;
+template<class T>
+class BasicMatrixView;
+template<class E, class T>
+class CastExpr;
+
+// BasicMatrix and BasicMatrixView are instantiated for float, double, long double, int and long;
+// Matrix stays the double matrix everything else in the library works with.
+typedef BasicMatrix<double> Matrix;
+typedef BasicMatrixView<double> MatrixView;
+
+// Per-element tolerance of ==: EPS for double and long double, FLOAT_EPS for float and exact
+// comparison for integers.
+template<class T>
+struct MatrixTraits {
+  static_assert(std::is_arithmetic<T>::value, "matrix elements must be arithmetic");
+
+  static T eps() { return std::is_integral<T>::value ? T(0) : T(EPS); }
+};
+
+template<>
+struct MatrixTraits<float> {
+  static float eps() { return FLOAT_EPS; }
+};
+
+// Selects the implicit constructor from expressions of the same element type, and the explicit
+// converting one for the rest.
+template<class E, class T>
+using IfSameElement = std::enable_if_t<std::is_same<typename E::value_type, T>::value, int>;
+template<class E, class T>
+using IfOtherElement = std::enable_if_t<!std::is_same<typename E::value_type, T>::value, int>;
+
+// CRTP base of everything that can be assigned to a matrix: the matrix itself, views and the lazy
+// element-wise nodes from matrix_expr.h. E provides value_type, getNumRows(), getNumCols(),
+// at(row, col) and overlaps(begin, end): whether it reads a view of storage in [begin, end).
+// A matrix leaf reports false since it only reads element (i, j) for element (i, j).
+template<class E>
+class MatrixExpr {
+ public:
+  const E &self() const { return static_cast<const E &>(*this); }
+
+  auto eval() const;
+  auto det() const;
+  auto trace() const;
+  auto transposed() const;
+  auto pow(uint64_t k) const;
+};
 
-class Matrix {
+template<class T>
+class BasicMatrix : public MatrixExpr<BasicMatrix<T>> {
  public:
-  Matrix();
-  Matrix(size_t rows, size_t cols);
-  Matrix(const Matrix &copy);
-  ~Matrix();
-  Matrix &operator=(const Matrix &a);
-
-  double &get(size_t row, size_t col);
-  const double &get(size_t row, size_t col) const;
-  void set(size_t row, size_t col, const double &value);
+  typedef T value_type;
+
+  BasicMatrix();
+  BasicMatrix(size_t rows, size_t cols);
+  // Copies share one reference-counted buffer; the first mutation through get, set, operator[],
+  // the compound assignments, transpose or resize gives the mutated matrix its own copy.
+  // Inline matrices are copied right away.
+  BasicMatrix(const BasicMatrix &copy);
+  // A moved-from matrix is left empty (0 x 0) and may only be assigned to or destroyed.
+  // Moving an inline matrix copies its elements.
+  BasicMatrix(BasicMatrix &&other) noexcept;
+  // Evaluates the whole expression tree in one pass over the new buffer.
+  template<class E, IfSameElement<E, T> = 0>
+  BasicMatrix(const MatrixExpr<E> &expr);
+  // Converts every element with static_cast; see also cast<U>() in matrix_expr.h.
+  template<class E, IfOtherElement<E, T> = 0>
+  explicit BasicMatrix(const MatrixExpr<E> &expr) : BasicMatrix(CastExpr<E, T>(expr.self())) {}
+  ~BasicMatrix();
+  BasicMatrix &operator=(const BasicMatrix &a);
+  BasicMatrix &operator=(BasicMatrix &&a) noexcept;
+  template<class E>
+  BasicMatrix &operator=(const MatrixExpr<E> &expr);
+
+  T &get(size_t row, size_t col);
+  const T &get(size_t row, size_t col) const;
+  void set(size_t row, size_t col, const T &value);
+  // Keeps the buffer when it is not shared and capacity() holds the new shape, otherwise moves to
+  // the inline storage or to the heap, whichever fits; the elements of the old shape that remain
+  // keep their values and the rest are zero.
   void resize(size_t new_rows, size_t new_cols);
+  // Capacity in elements, counting row padding; it never shrinks below the current shape.
+  // shrinkToFit moves a shape that fits MATRIX_INLINE_ELEMENTS back into the object.
+  size_t capacity() const;
+  void reserve(size_t elements);
+  void shrinkToFit();
 
-  double *operator[](size_t row);
-  double *operator[](size_t row) const;
+  // Row pointers of a non-const matrix are taken after it is made unique, but they point into
+  // storage that a later copy shares again; the const overload must only be read through.
+  T *operator[](size_t row);
+  T *operator[](size_t row) const;
+  T at(size_t row, size_t col) const { return this->mat_values[row * this->row_stride + col]; }
+  bool overlaps(const void *, const void *) const { return false; }
 
-  Matrix &operator+=(const Matrix &a);
-  Matrix &operator-=(const Matrix &a);
-  Matrix &operator*=(const Matrix &a);
-  Matrix &operator*=(const double &number);
+  BasicMatrix &operator+=(const BasicMatrix &a);
+  BasicMatrix &operator-=(const BasicMatrix &a);
+  template<class E>
+  BasicMatrix &operator+=(const MatrixExpr<E> &expr);
+  template<class E>
+  BasicMatrix &operator-=(const MatrixExpr<E> &expr);
+  BasicMatrix &operator*=(const BasicMatrix &a);
+  BasicMatrix &operator*=(const T &number);
 
-  Matrix operator+(const Matrix &a) const;
-  Matrix operator-(const Matrix &a) const;
-  Matrix operator*(const Matrix &a) const;
-  Matrix operator*(const double &a) const;
+  // Element-wise +, - and scalar * of lvalues build lazy expressions (matrix_expr.h);
+  // the && overloads compute the result in the buffer of a temporary operand instead.
+  BasicMatrix operator*(const T &a) &&;
 
-  Matrix operator-() const;
-  Matrix operator+() const;
+  BasicMatrix operator-() &&;
+  BasicMatrix operator+() const &;
+  BasicMatrix operator+() &&;
 
-  double det() const;
+  T det() const;
+  // A^k of a square matrix by repeated squaring: about log2 k squarings and one more product per set
+  // bit of k, ping-ponging between three matrices allocated once whatever k is. gemm's pack panels
+  // are reused from product to product through the thread's buffer pool (a local one if none is
+  // plugged in); products split over the thread pool still pack into fresh panels on the workers,
+  // and Strassen, once enabled, allocates its workspace per product. A diagonal matrix has its
+  // diagonal raised element by element instead; pow(0) is the identity.
+  BasicMatrix pow(uint64_t k) const;
+  // Transposes within the matrix's own buffer once it is detached from its copies. A non-square one
+  // is packed to a dense array, permuted by cycle-following with an n-bit visited mask (the only
+  // allocation, n = rows * cols), and spread back to an aligned stride when the buffer has room.
   void transpose();
-  Matrix transposed() const;
-  double trace() const;
+  BasicMatrix transposed() const &;
+  BasicMatrix transposed() &&;
+  T trace() const;
 
-  std::vector<double> getRow(size_t row);
-  std::vector<double> getColumn(size_t column);
+  std::vector<T> getRow(size_t row);
+  std::vector<T> getColumn(size_t column);
 
-  bool operator==(const Matrix &a) const;
-  bool operator!=(const Matrix &a) const;
+  // Non-owning views (matrix_view.h); they stay valid until the matrix is resized, reassigned, moved from
+  // or destroyed, or first mutated while it shares its buffer with a copy.
+  BasicMatrixView<T> view() const;
+  BasicMatrixView<T> transposedView() const;
+  BasicMatrixView<T> row(size_t row) const;
+  BasicMatrixView<T> column(size_t column) const;
+  BasicMatrixView<T> block(size_t row, size_t col, size_t rows, size_t cols) const;
+
+  bool operator==(const BasicMatrix &a) const;
+  bool operator!=(const BasicMatrix &a) const;
+  template<class E>
+  bool operator==(const MatrixExpr<E> &expr) const;
+  template<class E>
+  bool operator!=(const MatrixExpr<E> &expr) const;
 
   size_t getNumCols() const;
   size_t getNumRows() const;
 
+  // Matrix product behind every operator* of two matrices, views or expressions (matrix_view.h).
+  static BasicMatrix multiply(const BasicMatrixView<T> &a, const BasicMatrixView<T> &b);
+
  private:
+  // Row-major elements, row i starts at mat_values + i * row_stride. Shapes that fit
+  // MATRIX_INLINE_ELEMENTS live in inline_values; larger ones in an ALIGNMENT-aligned heap buffer
+  // from allocateBuffer (buffer_pool.h), whose ALIGNMENT bytes before mat_values hold a
+  // BufferHeader: how many matrices share the buffer and its capacity.
   size_t n_rows;
   size_t n_cols;
-  double **mat_values;
+  size_t row_stride;
+  T *mat_values;
+  T inline_values[std::max<size_t>(MATRIX_INLINE_ELEMENTS, 1)];
+
+  // Uninitialized elements.
+  BasicMatrix(size_t rows, size_t cols, size_t stride);
 
-  static double **init_zero_matrix(size_t rows, size_t cols);
-  static void matrix_copy(double **from, double **to, size_t rows, size_t cols);
-  static void free_matrix(double **ptr, size_t size);
+  template<class E>
+  void assign_expr(const E &expr);
+  // Whether expr reads a view into this matrix's storage, which it may read at other positions than
+  // the one being written; such expressions are evaluated into a temporary first.
+  template<class E>
+  bool aliased_by(const E &expr) const;
+  // c = a b for a c with row stride ldc that overlaps neither factor; shapes are checked and the
+  // MULTIPLY scope is opened by the caller.
+  static void multiply_into(const BasicMatrixView<T> &a, const BasicMatrixView<T> &b, T *c, size_t ldc);
+  bool is_diagonal() const;
+  // Gives this matrix its own buffer if it shares one; every mutator calls it first.
+  void detach();
+  bool is_inline() const { return this->mat_values == this->inline_values; }
+  bool is_shared() const;
+  void take_storage(BasicMatrix &other) noexcept;
 
+  static size_t aligned_stride(size_t cols);
+  T *init_matrix(size_t rows, size_t stride);
+  T *init_zero_matrix(size_t rows, size_t stride);
+  static void matrix_copy(const T *from, size_t from_stride, T *to, size_t to_stride,
+                          size_t rows, size_t cols);
+  // Drops this matrix's reference to a heap buffer; inline storage needs no release.
+  void free_matrix();
+  struct BufferHeader;
+  static BufferHeader &header(T *ptr);
+  static T *alloc_buffer(size_t elements, bool exact);
+  void reallocate(size_t elements, bool exact);
+  static void transpose_copy(const T *from, size_t from_stride, T *to, size_t to_stride,
+                             size_t rows, size_t cols);
+  static void transpose_swap(T *a, T *b, size_t stride, size_t rows, size_t cols);
+  static void transpose_square(T *values, size_t size, size_t stride);
+  static void transpose_dense(T *values, size_t rows, size_t cols);
 };
 
-Matrix operator*(const double &a, const Matrix &b);
+template<class T>
+BasicMatrix<T> operator+(BasicMatrix<T> &&a, BasicMatrix<T> &&b);
+template<class T>
+BasicMatrix<T> operator-(BasicMatrix<T> &&a, BasicMatrix<T> &&b);
+template<class T>
+BasicMatrix<T> operator*(const typename BasicMatrix<T>::value_type &a, BasicMatrix<T> &&b);
 
-std::ostream &operator<<(std::ostream &output, const Matrix &matrix);
-std::istream &operator>>(std::istream &input, Matrix &matrix);
+// Defined in matrix_io.cpp: numbers are formatted with to_chars and parsed with from_chars.
+template<class T>
+std::ostream &operator<<(std::ostream &output, const BasicMatrix<T> &matrix);
+template<class T>
+std::istream &operator>>(std::istream &input, BasicMatrix<T> &matrix);
+
+// Matrix-vector products and the rank-1 update on std::vector<double> (gemv, gevm and ger in gemm.h).
+// multiply() writes into a caller-provided y, resized to the result length, so it does not allocate
+// once y has the capacity; y must not be x.
+std::vector<double> operator*(const Matrix &a, const std::vector<double> &x);
+std::vector<double> operator*(const std::vector<double> &x, const Matrix &a);
+void multiply(const Matrix &a, const std::vector<double> &x, std::vector<double> &y);
+void multiply(const std::vector<double> &x, const Matrix &a, std::vector<double> &y);
+// a += alpha x y^T.
+void rankOneUpdate(Matrix &a, double alpha, const std::vector<double> &x, const std::vector<double> &y);
 
 }  // namespace task
+
+#include "matrix_expr.h"
+#include "matrix_view.h"
@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <utility>
+#include "matrix_batch.h"
+
+using namespace task;
+
+namespace {
+
+const size_t LANE_CHUNK = 256;
+
+}  // namespace
+
+size_t MatrixBatch::aligned_lane(size_t count) {
+  const size_t line = ALIGNMENT / sizeof(double);
+
+  return (count + line - 1) / line * line;
+}
+
+double *MatrixBatch::alloc_lanes(size_t n_lanes, size_t lane_stride) {
+  return new(std::align_val_t(ALIGNMENT)) double[n_lanes * lane_stride];
+}
+
+double *MatrixBatch::alloc_zero_lanes(size_t n_lanes, size_t lane_stride) {
+  double *lanes = alloc_lanes(n_lanes, lane_stride);
+
+  std::fill(lanes, lanes + n_lanes * lane_stride, 0.);
+  return lanes;
+}
+
+void MatrixBatch::free_lanes(double *ptr) { ::operator delete[](ptr, std::align_val_t(ALIGNMENT)); }
+
+MatrixBatch::MatrixBatch(size_t count, size_t rows, size_t cols)
+    : count(count), n_rows(rows), n_cols(cols), lane_stride(aligned_lane(count)) {
+  if (count == 0 or rows == 0 or cols == 0)
+    throw OutOfBoundsException();
+
+  this->values = alloc_zero_lanes(rows * cols, this->lane_stride);
+  for (size_t i = 0; i < std::min(rows, cols); ++i)
+    std::fill(lane(i, i), lane(i, i) + count, 1.);
+}
+
+MatrixBatch::MatrixBatch(const MatrixBatch &copy)
+    : count(copy.count), n_rows(copy.n_rows), n_cols(copy.n_cols), lane_stride(copy.lane_stride),
+      values(alloc_lanes(copy.n_rows * copy.n_cols, copy.lane_stride)) {
+  std::copy(copy.values, copy.values + this->n_rows * this->n_cols * this->lane_stride, this->values);
+}
+
+MatrixBatch::MatrixBatch(size_t count, size_t rows, size_t cols, size_t lane_stride, double *values)
+    : count(count), n_rows(rows), n_cols(cols), lane_stride(lane_stride), values(values) {}
+
+MatrixBatch::MatrixBatch(MatrixBatch &&other) noexcept
+    : count(other.count), n_rows(other.n_rows), n_cols(other.n_cols), lane_stride(other.lane_stride),
+      values(other.values) {
+  other.count = other.n_rows = other.n_cols = other.lane_stride = 0;
+  other.values = nullptr;
+}
+
+MatrixBatch::~MatrixBatch() { free_lanes(this->values); }
+
+MatrixBatch &MatrixBatch::operator=(const MatrixBatch &a) {
+  if (this != &a)
+    *this = MatrixBatch(a);
+  return *this;
+}
+
+MatrixBatch &MatrixBatch::operator=(MatrixBatch &&a) noexcept {
+  std::swap(this->count, a.count);
+  std::swap(this->n_rows, a.n_rows);
+  std::swap(this->n_cols, a.n_cols);
+  std::swap(this->lane_stride, a.lane_stride);
+  std::swap(this->values, a.values);
+  return *this;
+}
+
+double &MatrixBatch::get(size_t index, size_t row, size_t col) {
+  if (index >= this->count or row >= this->n_rows or col >= this->n_cols)
+    throw OutOfBoundsException();
+  else
+    return lane(row, col)[index];
+}
+
+const double &MatrixBatch::get(size_t index, size_t row, size_t col) const {
+  if (index >= this->count or row >= this->n_rows or col >= this->n_cols)
+    throw OutOfBoundsException();
+  else
+    return lane(row, col)[index];
+}
+
+Matrix MatrixBatch::getMatrix(size_t index) const {
+  if (index >= this->count)
+    throw OutOfBoundsException();
+
+  Matrix matrix(this->n_rows, this->n_cols);
+  for (size_t i = 0; i < this->n_rows; ++i)
+    for (size_t j = 0; j < this->n_cols; ++j)
+      matrix[i][j] = lane(i, j)[index];
+  return matrix;
+}
+
+void MatrixBatch::setMatrix(size_t index, const Matrix &matrix) {
+  if (index >= this->count)
+    throw OutOfBoundsException();
+  else if (matrix.getNumRows() != this->n_rows or matrix.getNumCols() != this->n_cols)
+    throw SizeMismatchException();
+
+  for (size_t i = 0; i < this->n_rows; ++i)
+    for (size_t j = 0; j < this->n_cols; ++j)
+      lane(i, j)[index] = matrix[i][j];
+}
+
+void MatrixBatch::find_pivots(size_t k, double *best, size_t *pivot) const {
+  const double *column = lane(k, k);
+  for (size_t l = 0; l < this->count; ++l) {
+    best[l] = std::fabs(column[l]);
+    pivot[l] = k;
+  }
+  for (size_t i = k + 1; i < this->n_rows; ++i) {
+    const double *candidate = lane(i, k);
+    for (size_t l = 0; l < this->count; ++l) {
+      bool larger = std::fabs(candidate[l]) > best[l];
+      best[l] = larger ? std::fabs(candidate[l]) : best[l];
+      pivot[l] = larger ? i : pivot[l];
+    }
+  }
+}
+
+void MatrixBatch::select_swap(const size_t *pivot, size_t a, size_t b, size_t from_col) {
+  for (size_t j = from_col; j < this->n_cols; ++j) {
+    double *row_a = lane(a, j), *row_b = lane(b, j);
+#pragma GCC ivdep
+    for (size_t l = 0; l < this->count; ++l) {
+      double value_a = row_a[l], value_b = row_b[l];
+      bool swap = pivot[l] == a;
+      row_a[l] = swap ? value_b : value_a;
+      row_b[l] = swap ? value_a : value_b;
+    }
+  }
+}
+
+void MatrixBatch::load_chunk(const MatrixBatch &from, size_t begin) {
+  size_t used = std::min(this->count, from.count - begin);
+  for (size_t i = 0; i < this->n_rows; ++i)
+    for (size_t j = 0; j < this->n_cols; ++j) {
+      const double *source = from.lane(i, j) + begin;
+      double *target = lane(i, j);
+      std::copy(source, source + used, target);
+      // Lanes past the end of the batch hold identity matrices, which never look singular.
+      std::fill(target + used, target + this->count, i == j ? 1. : 0.);
+    }
+}
+
+void MatrixBatch::store_chunk(MatrixBatch &to, size_t begin) const {
+  size_t used = std::min(this->count, to.count - begin);
+  for (size_t i = 0; i < this->n_rows; ++i)
+    for (size_t j = 0; j < this->n_cols; ++j)
+      std::copy(lane(i, j), lane(i, j) + used, to.lane(i, j) + begin);
+}
+
+void MatrixBatch::eliminate(double *det) {
+  size_t n = this->n_rows;
+  std::vector<double> best(this->count), divisor(this->count);
+  std::vector<size_t> pivot(this->count);
+  std::fill(det, det + this->count, 1.);
+
+  for (size_t k = 0; k < n; ++k) {
+    // Pivot search and row swaps are branch-free selects along the lanes.
+    find_pivots(k, best.data(), pivot.data());
+#pragma GCC ivdep
+    for (size_t l = 0; l < this->count; ++l)
+      det[l] = pivot[l] != k ? -det[l] : det[l];
+    for (size_t i = k + 1; i < n; ++i)
+      select_swap(pivot.data(), i, k, k);
+
+    // A zero pivot zeroes the determinant and, with factors forced to 0, leaves the other rows alone.
+    // Factors are divided rather than multiplied by a reciprocal, so equal rows cancel exactly as in
+    // LUDecomposition.
+    const double *pivot_row = lane(k, k);
+#pragma GCC ivdep
+    for (size_t l = 0; l < this->count; ++l) {
+      det[l] *= pivot_row[l];
+      divisor[l] = pivot_row[l] == 0. ? 1. : pivot_row[l];
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      double *factor = lane(i, k);
+#pragma GCC ivdep
+      for (size_t l = 0; l < this->count; ++l)
+        factor[l] = pivot_row[l] == 0. ? 0. : factor[l] / divisor[l];
+      for (size_t j = k + 1; j < n; ++j) {
+        double *target = lane(i, j);
+        const double *source = lane(k, j);
+#pragma GCC ivdep
+        for (size_t l = 0; l < this->count; ++l)
+          target[l] -= factor[l] * source[l];
+      }
+    }
+  }
+}
+
+void MatrixBatch::gauss_jordan(MatrixBatch &inv) {
+  size_t n = this->n_rows;
+  std::vector<double> best(this->count);
+  std::vector<size_t> pivot(this->count);
+
+  for (size_t k = 0; k < n; ++k) {
+    find_pivots(k, best.data(), pivot.data());
+    if (std::find(best.begin(), best.end(), 0.) != best.end())
+      throw SingularMatrixException();
+    for (size_t i = k + 1; i < n; ++i) {
+      select_swap(pivot.data(), i, k, 0);
+      inv.select_swap(pivot.data(), i, k, 0);
+    }
+
+    // Eliminate with the unnormalized pivot row first, so equal rows cancel exactly, then scale it.
+    const double *pivot_row = lane(k, k);
+    for (size_t i = 0; i < n; ++i) {
+      if (i == k)
+        continue;
+      const double *a_ik = lane(i, k);
+#pragma GCC ivdep
+      for (size_t l = 0; l < this->count; ++l)
+        best[l] = a_ik[l] / pivot_row[l];
+      for (size_t j = 0; j < n; ++j) {
+        double *a_ij = lane(i, j), *inv_ij = inv.lane(i, j);
+        const double *a_kj = lane(k, j), *inv_kj = inv.lane(k, j);
+#pragma GCC ivdep
+        for (size_t l = 0; l < this->count; ++l) {
+          a_ij[l] -= best[l] * a_kj[l];
+          inv_ij[l] -= best[l] * inv_kj[l];
+        }
+      }
+    }
+    std::copy(pivot_row, pivot_row + this->count, best.begin());
+    for (size_t j = 0; j < n; ++j) {
+      double *a_kj = lane(k, j), *inv_kj = inv.lane(k, j);
+#pragma GCC ivdep
+      for (size_t l = 0; l < this->count; ++l) {
+        a_kj[l] /= best[l];
+        inv_kj[l] /= best[l];
+      }
+    }
+  }
+}
+
+std::vector<double> MatrixBatch::det() const {
+  if (this->n_rows != this->n_cols)
+    throw SizeMismatchException();
+
+  size_t n = this->n_rows;
+  std::vector<double> det(this->count);
+  double *out = det.data();
+
+  if (n == 1) {
+    std::copy(lane(0, 0), lane(0, 0) + this->count, out);
+  } else if (n == 2) {
+    const double *a = lane(0, 0), *b = lane(0, 1), *c = lane(1, 0), *d = lane(1, 1);
+#pragma GCC ivdep
+    for (size_t k = 0; k < this->count; ++k)
+      out[k] = a[k] * d[k] - b[k] * c[k];
+  } else if (n == 3) {
+    const double *m00 = lane(0, 0), *m01 = lane(0, 1), *m02 = lane(0, 2);
+    const double *m10 = lane(1, 0), *m11 = lane(1, 1), *m12 = lane(1, 2);
+    const double *m20 = lane(2, 0), *m21 = lane(2, 1), *m22 = lane(2, 2);
+#pragma GCC ivdep
+    for (size_t k = 0; k < this->count; ++k)
+      out[k] = m00[k] * (m11[k] * m22[k] - m12[k] * m21[k])
+          - m01[k] * (m10[k] * m22[k] - m12[k] * m20[k])
+          + m02[k] * (m10[k] * m21[k] - m11[k] * m20[k]);
+  } else {
+    // Elimination runs on one cache-resident chunk of lanes at a time.
+    MatrixBatch chunk(std::min(LANE_CHUNK, this->count), n, n);
+    std::vector<double> chunk_det(chunk.count);
+    for (size_t begin = 0; begin < this->count; begin += chunk.count) {
+      chunk.load_chunk(*this, begin);
+      chunk.eliminate(chunk_det.data());
+      std::copy(chunk_det.begin(), chunk_det.begin() + std::min(chunk.count, this->count - begin), out + begin);
+    }
+  }
+  return det;
+}
+
+std::vector<double> MatrixBatch::trace() const {
+  if (this->n_rows != this->n_cols)
+    throw SizeMismatchException();
+
+  std::vector<double> trace(this->count, 0.);
+  for (size_t i = 0; i < this->n_rows; ++i) {
+    const double *diagonal = lane(i, i);
+#pragma GCC ivdep
+    for (size_t k = 0; k < this->count; ++k)
+      trace[k] += diagonal[k];
+  }
+  return trace;
+}
+
+MatrixBatch MatrixBatch::inverse() const {
+  if (this->n_rows != this->n_cols)
+    throw SizeMismatchException();
+
+  size_t n = this->n_rows;
+  MatrixBatch inv(this->count, n, n, this->lane_stride, alloc_lanes(n * n, this->lane_stride));
+
+  if (n <= 3) {
+    // Adjugate over determinant; the determinant lanes are checked once for singular matrices.
+    std::vector<double> det = this->det();
+    if (std::find(det.begin(), det.end(), 0.) != det.end())
+      throw SingularMatrixException();
+    for (double &value : det)
+      value = 1. / value;
+    const double *inv_det = det.data();
+
+    if (n == 1) {
+      std::copy(inv_det, inv_det + this->count, inv.lane(0, 0));
+    } else if (n == 2) {
+      const double *a = lane(0, 0), *b = lane(0, 1), *c = lane(1, 0), *d = lane(1, 1);
+      double *r00 = inv.lane(0, 0), *r01 = inv.lane(0, 1), *r10 = inv.lane(1, 0), *r11 = inv.lane(1, 1);
+#pragma GCC ivdep
+      for (size_t k = 0; k < this->count; ++k) {
+        r00[k] = d[k] * inv_det[k];
+        r01[k] = -b[k] * inv_det[k];
+        r10[k] = -c[k] * inv_det[k];
+        r11[k] = a[k] * inv_det[k];
+      }
+    } else {
+      // inv(i, j) is the (j, i) cofactor: the 2 x 2 minor on the other two rows and columns,
+      // taken in cyclic order so that the sign comes out right.
+      for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 3; ++j) {
+          size_t r1 = (j + 1) % 3, r2 = (j + 2) % 3, c1 = (i + 1) % 3, c2 = (i + 2) % 3;
+          const double *a = lane(r1, c1), *b = lane(r1, c2), *c = lane(r2, c1), *d = lane(r2, c2);
+          double *result = inv.lane(i, j);
+#pragma GCC ivdep
+          for (size_t k = 0; k < this->count; ++k)
+            result[k] = (a[k] * d[k] - b[k] * c[k]) * inv_det[k];
+        }
+    }
+    return inv;
+  }
+
+  // Gauss-Jordan one cache-resident chunk of lanes at a time, with the same pivoting as det().
+  MatrixBatch chunk(std::min(LANE_CHUNK, this->count), n, n);
+  for (size_t begin = 0; begin < this->count; begin += chunk.count) {
+    MatrixBatch chunk_inv(chunk.count, n, n);
+    chunk.load_chunk(*this, begin);
+    chunk.gauss_jordan(chunk_inv);
+    chunk_inv.store_chunk(inv, begin);
+  }
+  return inv;
+}
+
+MatrixBatch MatrixBatch::operator*(const MatrixBatch &a) const {
+  if (this->count != a.count or this->n_cols != a.n_rows)
+    throw SizeMismatchException();
+
+  // Lanes are walked in chunks so every operand lane of a chunk stays in L1 across the i, j, p loops.
+  MatrixBatch result(this->count, this->n_rows, a.n_cols, this->lane_stride,
+                     alloc_lanes(this->n_rows * a.n_cols, this->lane_stride));
+  for (size_t begin = 0; begin < this->count; begin += LANE_CHUNK) {
+    size_t end = std::min(begin + LANE_CHUNK, this->count);
+    for (size_t i = 0; i < this->n_rows; ++i)
+      for (size_t j = 0; j < a.n_cols; ++j) {
+        double *out = result.lane(i, j);
+        const double *left = lane(i, 0), *right = a.lane(0, j);
+#pragma GCC ivdep
+        for (size_t k = begin; k < end; ++k)
+          out[k] = left[k] * right[k];
+        for (size_t p = 1; p < this->n_cols; ++p) {
+          left = lane(i, p);
+          right = a.lane(p, j);
+#pragma GCC ivdep
+          for (size_t k = begin; k < end; ++k)
+            out[k] += left[k] * right[k];
+        }
+      }
+  }
+  return result;
+}
+
+size_t MatrixBatch::size() const { return this->count; }
+
+size_t MatrixBatch::getNumRows() const { return this->n_rows; }
+
+size_t MatrixBatch::getNumCols() const { return this->n_cols; }
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// count matrices of one rows x cols shape in structure-of-arrays layout: element (row, col) of all
+// matrices is one contiguous, ALIGNMENT-aligned lane, lane(row, col)[index]. Every batched kernel
+// runs its innermost loop along a lane, so the compiler vectorizes across the batch (8 doubles per
+// AVX-512 register) with the same instruction stream for every matrix.
+class MatrixBatch {
+ public:
+  // Like Matrix(rows, cols): every matrix starts with ones on the main diagonal.
+  MatrixBatch(size_t count, size_t rows, size_t cols);
+  MatrixBatch(const MatrixBatch &copy);
+  MatrixBatch(MatrixBatch &&other) noexcept;
+  ~MatrixBatch();
+  MatrixBatch &operator=(const MatrixBatch &a);
+  MatrixBatch &operator=(MatrixBatch &&a) noexcept;
+
+  double &get(size_t index, size_t row, size_t col);
+  const double &get(size_t index, size_t row, size_t col) const;
+  double *lane(size_t row, size_t col) { return this->values + (row * this->n_cols + col) * this->lane_stride; }
+  const double *lane(size_t row, size_t col) const {
+    return this->values + (row * this->n_cols + col) * this->lane_stride;
+  }
+
+  Matrix getMatrix(size_t index) const;
+  void setMatrix(size_t index, const Matrix &matrix);
+
+  // Closed forms up to 3 x 3; larger sizes run Gaussian elimination with a partial pivot chosen
+  // per matrix, vectorized across the batch.
+  std::vector<double> det() const;
+  std::vector<double> trace() const;
+  // Throws SingularMatrixException if any matrix of the batch is singular.
+  MatrixBatch inverse() const;
+  // Matrix-by-matrix products of two batches of the same count.
+  MatrixBatch operator*(const MatrixBatch &a) const;
+
+  size_t size() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  size_t count;
+  size_t n_rows;
+  size_t n_cols;
+  size_t lane_stride;
+  double *values;
+
+  MatrixBatch(size_t count, size_t rows, size_t cols, size_t lane_stride, double *values);
+
+  // Copy lanes [begin, begin + count) of a larger batch in or out of this chunk-sized one.
+  void load_chunk(const MatrixBatch &from, size_t begin);
+  void store_chunk(MatrixBatch &to, size_t begin) const;
+  // In-place kernels behind det() and inverse() for sizes without a closed form; inv starts as identity.
+  void eliminate(double *det);
+  void gauss_jordan(MatrixBatch &inv);
+  // For every matrix l, best[l] and pivot[l] get the largest |element| of column k at or below row k
+  // and its row.
+  void find_pivots(size_t k, double *best, size_t *pivot) const;
+  // Swaps rows a and b from column from_col on in the matrices whose pivot[l] == a.
+  void select_swap(const size_t *pivot, size_t a, size_t b, size_t from_col);
+
+  static size_t aligned_lane(size_t count);
+  static double *alloc_lanes(size_t n_lanes, size_t lane_stride);
+  static double *alloc_zero_lanes(size_t n_lanes, size_t lane_stride);
+  static void free_lanes(double *ptr);
+};
+
+}  // namespace task
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "matrix_chain.h"
+#include "gemm.h"
+
+using namespace task;
+
+namespace {
+
+// Optimal split of every subchain [i, j], stored as split[i * n + j].
+std::vector<size_t> optimal_splits(const std::vector<size_t> &dims, size_t &cost) {
+  size_t n = dims.size() - 1;
+  std::vector<size_t> best(n * n, 0), split(n * n, 0);
+
+  for (size_t length = 2; length <= n; ++length)
+    for (size_t i = 0; i + length <= n; ++i) {
+      size_t j = i + length - 1;
+      best[i * n + j] = std::numeric_limits<size_t>::max();
+      for (size_t k = i; k < j; ++k) {
+        size_t candidate = best[i * n + k] + best[(k + 1) * n + j] + dims[i] * dims[k + 1] * dims[j + 1];
+        if (candidate < best[i * n + j]) {
+          best[i * n + j] = candidate;
+          split[i * n + j] = k;
+        }
+      }
+    }
+  cost = best[n - 1];
+  return split;
+}
+
+void collect_steps(const std::vector<size_t> &split, const std::vector<size_t> &dims, size_t i, size_t j,
+                   std::vector<ChainStep> &steps) {
+  if (i == j)
+    return;
+
+  size_t n = dims.size() - 1;
+  size_t k = split[i * n + j];
+  collect_steps(split, dims, i, k, steps);
+  collect_steps(split, dims, k + 1, j, steps);
+  steps.push_back({i, k, j, dims[i], dims[j + 1]});
+}
+
+// Scratch buffers for intermediate products: a released buffer is handed out again to the next
+// product that fits in its capacity, so a chain allocates about as many buffers as its plan is deep.
+class BufferPool {
+ public:
+  static const size_t NONE = std::numeric_limits<size_t>::max();
+
+  // Prefers the smallest free buffer that fits, then the largest one (which grows), then a new one.
+  size_t acquire(size_t size) {
+    size_t chosen = NONE;
+    for (size_t index : this->free)
+      if (chosen == NONE or fits_better(index, chosen, size))
+        chosen = index;
+
+    if (chosen == NONE) {
+      chosen = this->buffers.size();
+      this->buffers.emplace_back();
+    } else {
+      this->free.erase(std::find(this->free.begin(), this->free.end(), chosen));
+    }
+    this->buffers[chosen].assign(size, 0.);
+    return chosen;
+  }
+
+  void release(size_t index) {
+    if (index != NONE)
+      this->free.push_back(index);
+  }
+
+  double *data(size_t index) { return this->buffers[index].data(); }
+
+ private:
+  std::vector<std::vector<double>> buffers;
+  std::vector<size_t> free;
+
+  bool fits_better(size_t a, size_t b, size_t size) const {
+    size_t capacity_a = this->buffers[a].capacity(), capacity_b = this->buffers[b].capacity();
+    if ((capacity_a >= size) != (capacity_b >= size))
+      return capacity_a >= size;
+    return capacity_a >= size ? capacity_a < capacity_b : capacity_a > capacity_b;
+  }
+};
+
+// One factor of a product: an operand read in place through its strides, or a partial product in a
+// pool buffer.
+struct Factor {
+  const double *data;
+  size_t row_stride;
+  size_t col_stride;
+  size_t buffer;
+};
+
+}  // namespace
+
+std::string ChainPlan::toString() const {
+  if (this->steps.empty())
+    return "A0";
+
+  // Every step replaces the strings of its halves, which are the latest ones that start at first
+  // and at split + 1.
+  std::vector<std::pair<size_t, std::string>> done;
+  for (const ChainStep &step : this->steps) {
+    std::string halves[2];
+    size_t starts[2] = {step.first, step.split + 1};
+    for (size_t h = 2; h-- > 0;) {
+      auto found = std::find_if(done.rbegin(), done.rend(), [&](const auto &part) { return part.first == starts[h]; });
+      if (found == done.rend()) {
+        halves[h] = "A" + std::to_string(starts[h]);
+      } else {
+        halves[h] = found->second;
+        done.erase(std::next(found).base());
+      }
+    }
+    done.emplace_back(step.first, "(" + halves[0] + " " + halves[1] + ")");
+  }
+  return done.back().second;
+}
+
+MatrixChain::MatrixChain(const MatrixView &first) : operands{first} {}
+
+MatrixChain &MatrixChain::operator*=(const MatrixView &a) {
+  if (a.getNumRows() != getNumCols())
+    throw SizeMismatchException();
+
+  this->operands.push_back(a);
+  return *this;
+}
+
+MatrixChain MatrixChain::operator*(const MatrixView &a) const & { return MatrixChain(*this) *= a; }
+
+MatrixChain MatrixChain::operator*(const MatrixView &a) && { return std::move(*this *= a); }
+
+size_t MatrixChain::size() const { return this->operands.size(); }
+
+size_t MatrixChain::getNumRows() const { return this->operands.front().getNumRows(); }
+
+size_t MatrixChain::getNumCols() const { return this->operands.back().getNumCols(); }
+
+ChainPlan MatrixChain::plan() const {
+  std::vector<size_t> dims{getNumRows()};
+  for (const MatrixView &operand : this->operands)
+    dims.push_back(operand.getNumCols());
+
+  ChainPlan plan;
+  std::vector<size_t> split = optimal_splits(dims, plan.cost);
+  collect_steps(split, dims, 0, size() - 1, plan.steps);
+
+  plan.left_to_right_cost = 0;
+  for (size_t k = 1; k < size(); ++k)
+    plan.left_to_right_cost += dims[0] * dims[k] * dims[k + 1];
+  return plan;
+}
+
+Matrix MatrixChain::evaluate() const {
+  if (size() == 1)
+    return Matrix(this->operands.front());
+
+  ChainPlan plan = this->plan();
+  BufferPool pool;
+  // Finished steps whose product is not consumed yet, as (first operand, factor).
+  std::vector<std::pair<size_t, Factor>> partials;
+
+  // A half of a step is a single operand or the latest partial product starting at its first operand.
+  auto take = [&](size_t first, size_t last) {
+    if (first == last) {
+      const MatrixView &operand = this->operands[first];
+      return Factor{operand.data(), operand.getRowStride(), operand.getColStride(), BufferPool::NONE};
+    }
+    auto found = std::find_if(partials.rbegin(), partials.rend(), [&](const auto &p) { return p.first == first; });
+    Factor factor = found->second;
+    partials.erase(std::next(found).base());
+    return factor;
+  };
+
+  Matrix result(getNumRows(), getNumCols());
+  for (size_t i = 0; i < std::min(getNumRows(), getNumCols()); ++i)
+    result[i][i] = 0.;
+
+  for (size_t s = 0; s < plan.steps.size(); ++s) {
+    const ChainStep &step = plan.steps[s];
+    Factor a = take(step.first, step.split);
+    Factor b = take(step.split + 1, step.last);
+    size_t k = this->operands[step.split].getNumCols();
+
+    // The last step writes straight into the result.
+    double *c = result[0];
+    size_t ldc = result.view().getRowStride();
+    size_t out = BufferPool::NONE;
+    if (s + 1 != plan.steps.size()) {
+      out = pool.acquire(step.rows * step.cols);
+      c = pool.data(out);
+      ldc = step.cols;
+    }
+    gemm(step.rows, step.cols, k, a.data, a.row_stride, a.col_stride, b.data, b.row_stride, b.col_stride, c, ldc);
+    if (out != BufferPool::NONE)
+      partials.emplace_back(step.first, Factor{c, step.cols, 1, out});
+    pool.release(a.buffer);
+    pool.release(b.buffer);
+  }
+  return result;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// One product of the plan: operands [first, last] are multiplied as [first, split] * [split + 1, last].
+struct ChainStep {
+  size_t first;
+  size_t split;
+  size_t last;
+  size_t rows;
+  size_t cols;
+};
+
+// Multiplication order chosen for a chain, in evaluation order (every step comes after the steps
+// of its two halves). Costs count multiply-adds.
+struct ChainPlan {
+  std::vector<ChainStep> steps;
+  size_t cost;
+  size_t left_to_right_cost;
+
+  // Parenthesization over operand indices, e.g. "((A0 A1) (A2 A3))".
+  std::string toString() const;
+};
+
+// Deferred product A0 * A1 * ... collected by operator* and evaluated in the order of least
+// multiply-adds, found by dynamic programming over the shapes. Operands are held as views, so
+// matrices must outlive the chain; intermediate products share a few scratch buffers.
+class MatrixChain {
+ public:
+  explicit MatrixChain(const MatrixView &first);
+
+  // Append an operand; throws SizeMismatchException if its rows differ from the current cols.
+  MatrixChain &operator*=(const MatrixView &a);
+  MatrixChain operator*(const MatrixView &a) const &;
+  MatrixChain operator*(const MatrixView &a) &&;
+
+  size_t size() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+  ChainPlan plan() const;
+  Matrix evaluate() const;
+
+ private:
+  std::vector<MatrixView> operands;
+};
+
+}  // namespace task
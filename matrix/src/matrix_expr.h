@@ -0,0 +1,287 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include "matrix.h"
+
+namespace task {
+
+// Leaves are held by reference, inner nodes by value, so a tree never outlives the matrices it names.
+template<class E>
+struct ExprOperand { typedef const E type; };
+
+template<class T>
+struct ExprOperand<BasicMatrix<T>> { typedef const BasicMatrix<T> &type; };
+
+struct AddOp {
+  template<class T>
+  static T apply(T a, T b) { return a + b; }
+};
+
+struct SubOp {
+  template<class T>
+  static T apply(T a, T b) { return a - b; }
+};
+
+// Both operands must have the same element type; convert one of them with cast<T>() first.
+template<class L, class R, class Op>
+class BinaryExpr : public MatrixExpr<BinaryExpr<L, R, Op>> {
+  static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+                "operands of an element-wise expression must have the same element type");
+
+ public:
+  typedef typename L::value_type value_type;
+
+  BinaryExpr(const L &left, const R &right) : left(left), right(right) {
+    if (left.getNumRows() != right.getNumRows() or left.getNumCols() != right.getNumCols())
+      throw SizeMismatchException();
+  }
+
+  size_t getNumRows() const { return this->left.getNumRows(); }
+  size_t getNumCols() const { return this->left.getNumCols(); }
+  value_type at(size_t row, size_t col) const {
+    return Op::template apply<value_type>(this->left.at(row, col), this->right.at(row, col));
+  }
+  bool overlaps(const void *begin, const void *end) const {
+    return this->left.overlaps(begin, end) or this->right.overlaps(begin, end);
+  }
+
+ private:
+  typename ExprOperand<L>::type left;
+  typename ExprOperand<R>::type right;
+};
+
+template<class E>
+class ScaledExpr : public MatrixExpr<ScaledExpr<E>> {
+ public:
+  typedef typename E::value_type value_type;
+
+  ScaledExpr(const E &expr, value_type factor) : expr(expr), factor(factor) {}
+
+  size_t getNumRows() const { return this->expr.getNumRows(); }
+  size_t getNumCols() const { return this->expr.getNumCols(); }
+  value_type at(size_t row, size_t col) const { return this->expr.at(row, col) * this->factor; }
+  bool overlaps(const void *begin, const void *end) const { return this->expr.overlaps(begin, end); }
+
+ private:
+  typename ExprOperand<E>::type expr;
+  value_type factor;
+};
+
+template<class E, class T>
+class CastExpr : public MatrixExpr<CastExpr<E, T>> {
+ public:
+  typedef T value_type;
+
+  explicit CastExpr(const E &expr) : expr(expr) {}
+
+  size_t getNumRows() const { return this->expr.getNumRows(); }
+  size_t getNumCols() const { return this->expr.getNumCols(); }
+  T at(size_t row, size_t col) const { return static_cast<T>(this->expr.at(row, col)); }
+  bool overlaps(const void *begin, const void *end) const { return this->expr.overlaps(begin, end); }
+
+ private:
+  typename ExprOperand<E>::type expr;
+};
+
+template<class L, class R>
+BinaryExpr<L, R, AddOp> operator+(const MatrixExpr<L> &a, const MatrixExpr<R> &b) {
+  return BinaryExpr<L, R, AddOp>(a.self(), b.self());
+}
+
+template<class L, class R>
+BinaryExpr<L, R, SubOp> operator-(const MatrixExpr<L> &a, const MatrixExpr<R> &b) {
+  return BinaryExpr<L, R, SubOp>(a.self(), b.self());
+}
+
+// Like + and -, a scalar product of an lvalue is a lazy ScaledExpr, no longer the Matrix it used to
+// be: `auto x = 2. * a;` holds a by reference, sees later writes to a, dangles once a is destroyed
+// and has no operator[]. Name the type (Matrix x = 2. * a;) or call eval() to get a matrix.
+// A temporary matrix operand takes the && overloads of matrix.h instead, which scale it in place
+// and return it, so `auto x = 2. * make_matrix();` is a Matrix that owns its elements.
+template<class E>
+ScaledExpr<E> operator*(const MatrixExpr<E> &a, const typename E::value_type &number) {
+  return ScaledExpr<E>(a.self(), number);
+}
+
+template<class E>
+ScaledExpr<E> operator*(const typename E::value_type &number, const MatrixExpr<E> &a) {
+  return ScaledExpr<E>(a.self(), number);
+}
+
+template<class E>
+ScaledExpr<E> operator-(const MatrixExpr<E> &a) { return ScaledExpr<E>(a.self(), -1); }
+
+// Lazy element type conversion: BasicMatrix<float> f = cast<float>(a + b) evaluates in one pass.
+template<class T, class E>
+CastExpr<E, T> cast(const MatrixExpr<E> &a) { return CastExpr<E, T>(a.self()); }
+
+template<class T, class R>
+BasicMatrix<T> operator+(BasicMatrix<T> &&a, const MatrixExpr<R> &b) {
+  a += b;
+
+  return std::move(a);
+}
+
+template<class T, class L>
+BasicMatrix<T> operator+(const MatrixExpr<L> &a, BasicMatrix<T> &&b) {
+  b += a;
+
+  return std::move(b);
+}
+
+template<class T, class R>
+BasicMatrix<T> operator-(BasicMatrix<T> &&a, const MatrixExpr<R> &b) {
+  a -= b;
+
+  return std::move(a);
+}
+
+template<class T, class L>
+BasicMatrix<T> operator-(const MatrixExpr<L> &a, BasicMatrix<T> &&b) {
+  b = a - b;
+
+  return std::move(b);
+}
+
+template<class L, class R>
+bool operator==(const MatrixExpr<L> &a, const MatrixExpr<R> &b) {
+  static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+                "compared matrices must have the same element type");
+  typedef typename L::value_type T;
+  const L &left = a.self();
+  const R &right = b.self();
+
+  if (left.getNumRows() != right.getNumRows() or left.getNumCols() != right.getNumCols())
+    return false;
+  for (size_t i = 0; i < left.getNumRows(); ++i)
+    for (size_t j = 0; j < left.getNumCols(); ++j) {
+      T x = left.at(i, j), y = right.at(i, j);
+      if ((x > y ? x - y : y - x) > MatrixTraits<T>::eps())
+        return false;
+    }
+  return true;
+}
+
+template<class L, class R>
+bool operator!=(const MatrixExpr<L> &a, const MatrixExpr<R> &b) { return !(a == b); }
+
+// Expressions and views print as the matrix they evaluate to.
+template<class E>
+std::ostream &operator<<(std::ostream &output, const MatrixExpr<E> &expr) { return output << expr.eval(); }
+
+template<class E>
+auto MatrixExpr<E>::eval() const { return BasicMatrix<typename E::value_type>(*this); }
+
+template<class E>
+auto MatrixExpr<E>::det() const { return eval().det(); }
+
+template<class E>
+auto MatrixExpr<E>::pow(uint64_t k) const { return eval().pow(k); }
+
+template<class E>
+auto MatrixExpr<E>::trace() const { return eval().trace(); }
+
+template<class E>
+auto MatrixExpr<E>::transposed() const { return eval().transposed(); }
+
+template<class T>
+template<class E, IfSameElement<E, T>>
+BasicMatrix<T>::BasicMatrix(const MatrixExpr<E> &expr)
+    : BasicMatrix(expr.self().getNumRows(), expr.self().getNumCols(), aligned_stride(expr.self().getNumCols())) {
+  assign_expr(expr.self());
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const MatrixExpr<E> &expr) {
+  static_assert(std::is_same<typename E::value_type, T>::value, "use cast<T>() to assign another element type");
+  const E &e = expr.self();
+
+  // A differently shaped target cannot be an operand of the expression, so it is safe to replace.
+  if (e.getNumRows() != this->n_rows or e.getNumCols() != this->n_cols)
+    *this = BasicMatrix(expr);
+  else
+    assign_expr(e);
+  return *this;
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const MatrixExpr<E> &expr) {
+  static_assert(std::is_same<typename E::value_type, T>::value, "use cast<T>() to add another element type");
+  const E &e = expr.self();
+
+  if (e.getNumRows() != this->n_rows or e.getNumCols() != this->n_cols)
+    throw SizeMismatchException();
+  detach();
+  if (aliased_by(e))
+    return *this += BasicMatrix(expr);
+  for (size_t i = 0; i < this->n_rows; ++i) {
+    T *row = this->mat_values + i * this->row_stride;
+#pragma GCC ivdep
+    for (size_t j = 0; j < this->n_cols; ++j)
+      row[j] += e.at(i, j);
+  }
+  return *this;
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const MatrixExpr<E> &expr) {
+  static_assert(std::is_same<typename E::value_type, T>::value, "use cast<T>() to subtract another element type");
+  const E &e = expr.self();
+
+  if (e.getNumRows() != this->n_rows or e.getNumCols() != this->n_cols)
+    throw SizeMismatchException();
+  detach();
+  if (aliased_by(e))
+    return *this -= BasicMatrix(expr);
+  for (size_t i = 0; i < this->n_rows; ++i) {
+    T *row = this->mat_values + i * this->row_stride;
+#pragma GCC ivdep
+    for (size_t j = 0; j < this->n_cols; ++j)
+      row[j] -= e.at(i, j);
+  }
+  return *this;
+}
+
+template<class T>
+template<class E>
+bool BasicMatrix<T>::operator==(const MatrixExpr<E> &expr) const {
+  return static_cast<const MatrixExpr<BasicMatrix> &>(*this) == expr;
+}
+
+template<class T>
+template<class E>
+bool BasicMatrix<T>::operator!=(const MatrixExpr<E> &expr) const { return !(*this == expr); }
+
+// Checked after detach(): a view into a buffer this matrix has just stopped sharing is safe to read.
+template<class T>
+template<class E>
+bool BasicMatrix<T>::aliased_by(const E &expr) const {
+  if (this->n_rows == 0 or this->n_cols == 0)
+    return false;
+  return expr.overlaps(this->mat_values, this->mat_values + (this->n_rows - 1) * this->row_stride + this->n_cols);
+}
+
+template<class T>
+template<class E>
+void BasicMatrix<T>::assign_expr(const E &expr) {
+  detach();
+  if (aliased_by(expr)) {
+    BasicMatrix result(this->n_rows, this->n_cols, aligned_stride(this->n_cols));
+
+    result.assign_expr(expr);
+    *this = std::move(result);
+    return;
+  }
+  for (size_t i = 0; i < this->n_rows; ++i) {
+    T *row = this->mat_values + i * this->row_stride;
+#pragma GCC ivdep
+    for (size_t j = 0; j < this->n_cols; ++j)
+      row[j] = expr.at(i, j);
+  }
+}
+
+}  // namespace task
@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <locale>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "matrix_io.h"
+
+using namespace task;
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "binary matrix files are little-endian");
+
+namespace {
+
+MatrixFileHeader make_header(size_t rows, size_t cols) {
+  MatrixFileHeader header{};
+
+  std::memcpy(header.magic, MATRIX_MAGIC, sizeof(header.magic));
+  header.version = MATRIX_FORMAT_VERSION;
+  header.dtype = static_cast<uint32_t>(MatrixDType::FLOAT64);
+  header.header_size = MATRIX_HEADER_SIZE;
+  header.rows = rows;
+  header.cols = cols;
+  return header;
+}
+
+// Returns the payload size in bytes.
+size_t check_header(const MatrixFileHeader &header) {
+  if (std::memcmp(header.magic, MATRIX_MAGIC, sizeof(header.magic)) != 0
+      or header.version != MATRIX_FORMAT_VERSION
+      or header.dtype != static_cast<uint32_t>(MatrixDType::FLOAT64)
+      or header.header_size != MATRIX_HEADER_SIZE
+      or header.rows == 0 or header.cols == 0)
+    throw MatrixFormatException();
+  if (header.rows > std::numeric_limits<size_t>::max() / sizeof(double) / header.cols)
+    throw MatrixFormatException();
+  return header.rows * header.cols * sizeof(double);
+}
+
+// Bytes left in input after the current position, when its buffer can seek.
+bool remaining_bytes(std::istream &input, size_t &bytes) {
+  std::streambuf *buffer = input.rdbuf();
+  std::streampos position = buffer->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+  if (position == std::streampos(-1))
+    return false;
+  std::streampos end = buffer->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+  buffer->pubseekpos(position, std::ios_base::in);
+  if (end == std::streampos(-1) or end < position)
+    return false;
+  bytes = static_cast<size_t>(end - position);
+  return true;
+}
+
+// Payload read at a time from streams that cannot tell their length.
+const size_t BINARY_READ_CHUNK = 1 << 20;
+
+const size_t TEXT_BUFFER_SIZE = 1 << 16;
+// Longest number we format: a fixed-notation 1e308 with MAX_TEXT_PRECISION digits after the point.
+const int MAX_TEXT_PRECISION = 100;
+const size_t MAX_NUMBER_LENGTH = 512;
+// Tokens up to this length are read into a stack buffer; longer ones go to a string.
+const size_t MAX_TOKEN_LENGTH = 64;
+
+// Formats every row as values separated by ' ' into a large buffer that is written out in bulk.
+// A negative precision selects the shortest round-trip representation; integers ignore both.
+template<class T>
+void write_rows(std::ostream &output, const BasicMatrixView<T> &matrix, std::chars_format format, int precision,
+                bool trailing_space) {
+  std::vector<char> buffer(TEXT_BUFFER_SIZE);
+  char *const end = buffer.data() + buffer.size();
+  char *position = buffer.data();
+
+  for (size_t i = 0; i < matrix.getNumRows(); ++i) {
+    for (size_t j = 0; j < matrix.getNumCols(); ++j) {
+      if (static_cast<size_t>(end - position) < MAX_NUMBER_LENGTH + 2) {
+        output.write(buffer.data(), position - buffer.data());
+        position = buffer.data();
+      }
+      T value = matrix.at(i, j);
+      if constexpr (std::is_integral<T>::value)
+        position = std::to_chars(position, end, value).ptr;
+      else if (precision < 0)
+        position = std::to_chars(position, end, value).ptr;
+      else
+        position = std::to_chars(position, end, value, format, precision).ptr;
+      if (trailing_space or j + 1 < matrix.getNumCols())
+        *position++ = ' ';
+    }
+    *position++ = '\n';
+  }
+  output.write(buffer.data(), position - buffer.data());
+}
+
+// Streams whose formatting to_chars cannot reproduce go through the locale-aware operators.
+bool plain_format(const std::ostream &output) {
+  std::ios_base::fmtflags special = std::ios_base::showpos | std::ios_base::showpoint | std::ios_base::uppercase;
+  std::ios_base::fmtflags floatfield = output.flags() & std::ios_base::floatfield;
+  std::ios_base::fmtflags basefield = output.flags() & std::ios_base::basefield;
+
+  return (output.flags() & special) == 0 and (basefield == 0 or basefield == std::ios_base::dec) and output.width() == 0 and output.precision() <= MAX_TEXT_PRECISION
+      and floatfield != (std::ios_base::fixed | std::ios_base::scientific) and output.getloc() == std::locale::classic();
+}
+
+// The "C" locale whitespace set, without the locale lookup std::isspace does per character.
+inline bool is_space(int c) { return c == ' ' or (c >= '\t' and c <= '\r'); }
+
+// Reads the next whitespace-delimited token straight from the stream buffer, leaving the stream
+// positioned right after it, the way operator>> for a number would. Tokens fit in token as a rule;
+// a longer one, say a number with many digits, continues in long_token, which then holds all of it.
+size_t read_token(std::istream &input, char *token, std::string &long_token) {
+  std::istream::sentry sentry(input);
+  if (!sentry)
+    return 0;
+
+  std::streambuf *buffer = input.rdbuf();
+  size_t length = 0;
+  for (int c = buffer->sgetc();; c = buffer->snextc()) {
+    if (c == std::char_traits<char>::eof()) {
+      input.setstate(std::ios_base::eofbit);
+      break;
+    }
+    if (is_space(c))
+      break;
+    if (length < MAX_TOKEN_LENGTH)
+      token[length] = static_cast<char>(c);
+    else {
+      if (length == MAX_TOKEN_LENGTH)
+        long_token.assign(token, length);
+      long_token.push_back(static_cast<char>(c));
+    }
+    ++length;
+  }
+  if (length == 0)
+    input.setstate(std::ios_base::failbit);
+  return length;
+}
+
+// from_chars rejects the leading '+' that stream extraction accepts.
+template<class T>
+bool parse_number(const char *first, const char *last, T &value) {
+  if (last - first > 1 and *first == '+' and first[1] != '-')
+    ++first;
+
+  std::from_chars_result result = std::from_chars(first, last, value);
+  return result.ec == std::errc() and result.ptr == last;
+}
+
+template<class T>
+bool extract(std::istream &input, T &value) {
+  char token[MAX_TOKEN_LENGTH];
+  std::string long_token;
+  size_t length = read_token(input, token, long_token);
+  const char *first = length > MAX_TOKEN_LENGTH ? long_token.data() : token;
+
+  if (length == 0)
+    return false;
+  if (!parse_number(first, first + length, value)) {
+    input.setstate(std::ios_base::failbit);
+    return false;
+  }
+  return true;
+}
+
+const char *skip_space(const char *first, const char *last) {
+  while (first != last and is_space(*first))
+    ++first;
+  return first;
+}
+
+template<class T>
+const char *parse_token(const char *first, const char *last, T &value) {
+  first = skip_space(first, last);
+  const char *token_end = first;
+  while (token_end != last and !is_space(*token_end))
+    ++token_end;
+
+  if (first == token_end or !parse_number(first, token_end, value))
+    throw MatrixFormatException();
+  return token_end;
+}
+
+}  // namespace
+
+template<class T>
+std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<T> &matrix) {
+  if (!plain_format(output)) {
+    for (size_t i = 0; i < matrix.getNumRows(); ++i) {
+      for (size_t j = 0; j < matrix.getNumCols(); ++j)
+        output << matrix[i][j] << ' ';
+      output << '\n';
+    }
+    return output;
+  }
+
+  std::ios_base::fmtflags floatfield = output.flags() & std::ios_base::floatfield;
+  std::chars_format format = floatfield == std::ios_base::fixed        ? std::chars_format::fixed
+                             : floatfield == std::ios_base::scientific ? std::chars_format::scientific
+                                                                       : std::chars_format::general;
+  write_rows(output, matrix.view(), format, static_cast<int>(output.precision()), true);
+  return output;
+}
+
+template<class T>
+std::istream &task::operator>>(std::istream &input, BasicMatrix<T> &matrix) {
+  size_t n_rows, n_cols;
+  if (!extract(input, n_rows) or !extract(input, n_cols))
+    return input;
+
+  matrix.resize(n_rows, n_cols);
+  for (size_t i = 0; i < n_rows; ++i)
+    for (size_t j = 0; j < n_cols; ++j)
+      if (!extract(input, matrix[i][j]))
+        return input;
+
+  return input;
+}
+
+template std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<float> &matrix);
+template std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<double> &matrix);
+template std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<long double> &matrix);
+template std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<int> &matrix);
+template std::ostream &task::operator<<(std::ostream &output, const BasicMatrix<long> &matrix);
+template std::istream &task::operator>>(std::istream &input, BasicMatrix<float> &matrix);
+template std::istream &task::operator>>(std::istream &input, BasicMatrix<double> &matrix);
+template std::istream &task::operator>>(std::istream &input, BasicMatrix<long double> &matrix);
+template std::istream &task::operator>>(std::istream &input, BasicMatrix<int> &matrix);
+template std::istream &task::operator>>(std::istream &input, BasicMatrix<long> &matrix);
+
+void task::writeText(std::ostream &output, const MatrixView &matrix) {
+  output << matrix.getNumRows() << ' ' << matrix.getNumCols() << '\n';
+  write_rows(output, matrix, std::chars_format::general, -1, false);
+}
+
+const char *task::parseText(const char *first, const char *last, Matrix &matrix) {
+  size_t n_rows, n_cols;
+  first = parse_token(first, last, n_rows);
+  first = parse_token(first, last, n_cols);
+  if (n_rows == 0 or n_cols == 0)
+    throw MatrixFormatException();
+
+  matrix.resize(n_rows, n_cols);
+  for (size_t i = 0; i < n_rows; ++i) {
+    double *row = matrix[i];
+    for (size_t j = 0; j < n_cols; ++j)
+      first = parse_token(first, last, row[j]);
+  }
+  return first;
+}
+
+void task::writeBinary(std::ostream &output, const MatrixView &matrix) {
+  size_t n_rows = matrix.getNumRows();
+  size_t n_cols = matrix.getNumCols();
+  MatrixFileHeader header = make_header(n_rows, n_cols);
+
+  output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  if (matrix.getColStride() == 1 and matrix.getRowStride() == n_cols) {
+    output.write(reinterpret_cast<const char *>(matrix.data()), n_rows * n_cols * sizeof(double));
+  } else {
+    std::vector<double> row(n_cols);
+    for (size_t i = 0; i < n_rows; ++i) {
+      for (size_t j = 0; j < n_cols; ++j)
+        row[j] = matrix.at(i, j);
+      output.write(reinterpret_cast<const char *>(row.data()), n_cols * sizeof(double));
+    }
+  }
+  if (!output)
+    throw MatrixIOException();
+}
+
+Matrix task::readBinary(std::istream &input) {
+  MatrixFileHeader header;
+
+  if (!input.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    throw MatrixFormatException();
+  size_t payload = check_header(header);
+
+  // The header is untrusted, so nothing is allocated for more values than the input holds: a seekable
+  // stream is measured first, any other is read in chunks before the matrix is built.
+  size_t available;
+  if (remaining_bytes(input, available)) {
+    if (available < payload)
+      throw MatrixFormatException();
+    Matrix matrix(header.rows, header.cols);
+    for (size_t i = 0; i < header.rows; ++i)
+      if (!input.read(reinterpret_cast<char *>(matrix[i]), header.cols * sizeof(double)))
+        throw MatrixFormatException();
+    return matrix;
+  }
+
+  std::vector<char> values;
+  while (values.size() < payload) {
+    size_t offset = values.size();
+    values.resize(offset + std::min(BINARY_READ_CHUNK, payload - offset));
+    if (!input.read(values.data() + offset, values.size() - offset))
+      throw MatrixFormatException();
+  }
+  Matrix matrix(header.rows, header.cols);
+  for (size_t i = 0; i < header.rows; ++i)
+    std::memcpy(matrix[i], values.data() + i * header.cols * sizeof(double), header.cols * sizeof(double));
+  return matrix;
+}
+
+void task::saveBinary(const std::string &path, const MatrixView &matrix) {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+
+  if (!output)
+    throw MatrixIOException();
+  writeBinary(output, matrix);
+  output.close();
+  if (!output)
+    throw MatrixIOException();
+}
+
+Matrix task::loadBinary(const std::string &path) {
+  MappedMatrix mapped(path);
+  Matrix matrix(mapped.getNumRows(), mapped.getNumCols());
+
+  const double *values = mapped.data();
+  for (size_t i = 0; i < mapped.getNumRows(); ++i)
+    std::copy(values + i * mapped.getNumCols(), values + (i + 1) * mapped.getNumCols(), matrix[i]);
+  return matrix;
+}
+
+MappedMatrix::MappedMatrix(const std::string &path) : mapping(nullptr), mapping_size(0), n_rows(0), n_cols(0) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw MatrixIOException();
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw MatrixIOException();
+  }
+  if (static_cast<size_t>(info.st_size) < MATRIX_HEADER_SIZE) {
+    ::close(fd);
+    throw MatrixFormatException();
+  }
+
+  void *mapping = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+    throw MatrixIOException();
+
+  try {
+    const auto &header = *static_cast<const MatrixFileHeader *>(mapping);
+    size_t payload = check_header(header);
+    if (static_cast<size_t>(info.st_size) - MATRIX_HEADER_SIZE < payload)
+      throw MatrixFormatException();
+    this->n_rows = header.rows;
+    this->n_cols = header.cols;
+  } catch (...) {
+    ::munmap(mapping, info.st_size);
+    throw;
+  }
+  this->mapping = mapping;
+  this->mapping_size = info.st_size;
+}
+
+MappedMatrix::MappedMatrix(MappedMatrix &&other) noexcept
+    : mapping(other.mapping), mapping_size(other.mapping_size), n_rows(other.n_rows), n_cols(other.n_cols) {
+  other.mapping = nullptr;
+  other.mapping_size = 0;
+  other.n_rows = 0;
+  other.n_cols = 0;
+}
+
+MappedMatrix::~MappedMatrix() {
+  if (this->mapping != nullptr)
+    ::munmap(this->mapping, this->mapping_size);
+}
+
+MappedMatrix &MappedMatrix::operator=(MappedMatrix &&a) noexcept {
+  std::swap(this->mapping, a.mapping);
+  std::swap(this->mapping_size, a.mapping_size);
+  std::swap(this->n_rows, a.n_rows);
+  std::swap(this->n_cols, a.n_cols);
+  return *this;
+}
+
+MatrixView MappedMatrix::view() const { return MatrixView(data(), this->n_rows, this->n_cols, this->n_cols, 1); }
+
+const double *MappedMatrix::data() const {
+  return reinterpret_cast<const double *>(static_cast<const char *>(this->mapping) + MATRIX_HEADER_SIZE);
+}
+
+size_t MappedMatrix::getNumRows() const { return this->n_rows; }
+
+size_t MappedMatrix::getNumCols() const { return this->n_cols; }
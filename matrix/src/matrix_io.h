@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "matrix.h"
+#include "matrix_view.h"
+
+namespace task {
+
+// Binary layout: a 64-byte little-endian header followed by rows * cols row-major values.
+// The payload starts on a 64-byte boundary, so a mapped file satisfies the Matrix alignment.
+const char MATRIX_MAGIC[4] = {'T', 'M', 'A', 'T'};
+const uint32_t MATRIX_FORMAT_VERSION = 1;
+const size_t MATRIX_HEADER_SIZE = 64;
+
+enum class MatrixDType : uint32_t {
+  FLOAT64 = 1,
+};
+
+struct MatrixFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t dtype;
+  uint32_t header_size;
+  uint64_t rows;
+  uint64_t cols;
+  uint8_t reserved[MATRIX_HEADER_SIZE - 32];
+};
+
+static_assert(sizeof(MatrixFileHeader) == MATRIX_HEADER_SIZE, "matrix file header must be 64 bytes");
+
+class MatrixFormatException : public std::exception {};
+class MatrixIOException : public std::exception {};
+
+// Streams must be opened in binary mode. Malformed or truncated input throws MatrixFormatException,
+// failed file operations throw MatrixIOException. A header announcing more values than the stream
+// or file holds is rejected before the matrix is allocated.
+void writeBinary(std::ostream &output, const MatrixView &matrix);
+Matrix readBinary(std::istream &input);
+void saveBinary(const std::string &path, const MatrixView &matrix);
+Matrix loadBinary(const std::string &path);
+
+// Text in the "rows cols" + row-major values layout that test/generate.py produces and operator>>
+// reads. writeText prints the shortest representation that reads back to the same double.
+// parseText reads one matrix from [first, last) and returns the position right after it; feed
+// it a whole file to parse a stream of matrices without going through istream extraction.
+void writeText(std::ostream &output, const MatrixView &matrix);
+const char *parseText(const char *first, const char *last, Matrix &matrix);
+
+// Read-only memory mapping of a binary matrix file. Opening it validates the header and maps the
+// file; pages are only read when view() is used, so no parsing or copying happens up front.
+// Views obtained from it must not outlive the MappedMatrix.
+class MappedMatrix {
+ public:
+  explicit MappedMatrix(const std::string &path);
+  MappedMatrix(const MappedMatrix &copy) = delete;
+  MappedMatrix(MappedMatrix &&other) noexcept;
+  ~MappedMatrix();
+  MappedMatrix &operator=(const MappedMatrix &a) = delete;
+  MappedMatrix &operator=(MappedMatrix &&a) noexcept;
+
+  MatrixView view() const;
+  const double *data() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  void *mapping;
+  size_t mapping_size;
+  size_t n_rows;
+  size_t n_cols;
+};
+
+}  // namespace task
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <sstream>
+#include "matrix_stats.h"
+
+using namespace task;
+
+namespace {
+
+struct OpCounters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> flops{0};
+  std::atomic<uint64_t> bytes_allocated{0};
+  std::atomic<uint64_t> nanoseconds{0};
+};
+
+OpCounters op_counters[MATRIX_OP_COUNT];
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> bytes_allocated{0};
+
+#ifdef TASK_MATRIX_STATS
+thread_local MatrixOpScope *current_scope = nullptr;
+#endif
+
+}  // namespace
+
+#ifdef TASK_MATRIX_STATS
+MatrixOpScope::MatrixOpScope(MatrixOp op, uint64_t flops)
+    : op(op), flops(flops), bytes_allocated(0), start(std::chrono::steady_clock::now()), parent(current_scope) {
+  current_scope = this;
+}
+
+MatrixOpScope::~MatrixOpScope() {
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - this->start;
+  OpCounters &counters = op_counters[static_cast<size_t>(this->op)];
+
+  counters.calls.fetch_add(1, std::memory_order_relaxed);
+  counters.flops.fetch_add(this->flops, std::memory_order_relaxed);
+  counters.bytes_allocated.fetch_add(this->bytes_allocated, std::memory_order_relaxed);
+  counters.nanoseconds.fetch_add(elapsed.count(), std::memory_order_relaxed);
+  // An outer operation allocated whatever its inner ones did.
+  if (this->parent != nullptr)
+    this->parent->bytes_allocated += this->bytes_allocated;
+  current_scope = this->parent;
+}
+
+void task::recordMatrixAllocation(size_t bytes) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+  if (current_scope != nullptr)
+    current_scope->bytes_allocated += bytes;
+}
+#endif
+
+const char *task::matrixOpName(MatrixOp op) {
+  switch (op) {
+    case MatrixOp::COPY: return "copy";
+    case MatrixOp::DETACH: return "detach";
+    case MatrixOp::MULTIPLY: return "multiply";
+    case MatrixOp::MULTIPLY_ASSIGN: return "multiply_assign";
+    case MatrixOp::POW: return "pow";
+    case MatrixOp::DET: return "det";
+    case MatrixOp::TRANSPOSE: return "transpose";
+    case MatrixOp::RESIZE: return "resize";
+  }
+  return "unknown";
+}
+
+MatrixStats task::getMatrixStats() {
+  MatrixStats stats;
+
+#ifdef TASK_MATRIX_STATS
+  stats.enabled = true;
+#endif
+  stats.allocations = allocations.load(std::memory_order_relaxed);
+  stats.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < MATRIX_OP_COUNT; ++i) {
+    stats.ops[i].calls = op_counters[i].calls.load(std::memory_order_relaxed);
+    stats.ops[i].flops = op_counters[i].flops.load(std::memory_order_relaxed);
+    stats.ops[i].bytes_allocated = op_counters[i].bytes_allocated.load(std::memory_order_relaxed);
+    stats.ops[i].nanoseconds = op_counters[i].nanoseconds.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void task::resetMatrixStats() {
+  allocations.store(0, std::memory_order_relaxed);
+  bytes_allocated.store(0, std::memory_order_relaxed);
+  for (OpCounters &counters : op_counters) {
+    counters.calls.store(0, std::memory_order_relaxed);
+    counters.flops.store(0, std::memory_order_relaxed);
+    counters.bytes_allocated.store(0, std::memory_order_relaxed);
+    counters.nanoseconds.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string MatrixStats::toJson() const {
+  std::ostringstream json;
+
+  json << "{\"enabled\": " << (this->enabled ? "true" : "false") << ", \"allocations\": " << this->allocations
+       << ", \"bytes_allocated\": " << this->bytes_allocated << ", \"ops\": {";
+  for (size_t i = 0; i < MATRIX_OP_COUNT; ++i) {
+    const MatrixOpStats &op = this->ops[i];
+    json << (i == 0 ? "" : ", ") << '"' << matrixOpName(static_cast<MatrixOp>(i)) << "\": {\"calls\": " << op.calls
+         << ", \"flops\": " << op.flops << ", \"bytes_allocated\": " << op.bytes_allocated
+         << ", \"nanoseconds\": " << op.nanoseconds << '}';
+  }
+  json << "}}";
+  return json.str();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace task {
+
+// Operation counters of BasicMatrix, compiled in only when every source is built with
+// -DTASK_MATRIX_STATS; otherwise the hooks below are empty and getMatrixStats() reports zeros.
+// Counters are shared by all element types and threads.
+enum class MatrixOp { COPY, DETACH, MULTIPLY, MULTIPLY_ASSIGN, POW, DET, TRANSPOSE, RESIZE };
+
+const size_t MATRIX_OP_COUNT = static_cast<size_t>(MatrixOp::RESIZE) + 1;
+
+// Time, flops and bytes are inclusive: the product inside operator*= counts for both MULTIPLY and
+// MULTIPLY_ASSIGN. Bytes are those of the buffers a call allocates, the result of a product
+// included and inline storage excluded.
+struct MatrixOpStats {
+  uint64_t calls = 0;
+  uint64_t flops = 0;
+  uint64_t bytes_allocated = 0;
+  uint64_t nanoseconds = 0;
+};
+
+struct MatrixStats {
+  bool enabled = false;
+  // Every matrix buffer allocated, within a counted operation or not.
+  uint64_t allocations = 0;
+  uint64_t bytes_allocated = 0;
+  MatrixOpStats ops[MATRIX_OP_COUNT];
+
+  const MatrixOpStats &operator[](MatrixOp op) const { return this->ops[static_cast<size_t>(op)]; }
+  // {"enabled": ..., "allocations": ..., "bytes_allocated": ..., "ops": {"copy": {"calls": ...}, ...}}
+  std::string toJson() const;
+};
+
+const char *matrixOpName(MatrixOp op);
+MatrixStats getMatrixStats();
+void resetMatrixStats();
+
+// Counts one call of op from construction to destruction; allocations in between are charged to
+// the innermost scope open on the thread.
+class MatrixOpScope {
+ public:
+#ifdef TASK_MATRIX_STATS
+  MatrixOpScope(MatrixOp op, uint64_t flops);
+  MatrixOpScope(const MatrixOpScope &) = delete;
+  MatrixOpScope &operator=(const MatrixOpScope &) = delete;
+  ~MatrixOpScope();
+
+ private:
+  MatrixOp op;
+  uint64_t flops;
+  uint64_t bytes_allocated;
+  std::chrono::steady_clock::time_point start;
+  MatrixOpScope *parent;
+
+  friend void recordMatrixAllocation(size_t bytes);
+#else
+  MatrixOpScope(MatrixOp, uint64_t) {}
+#endif
+};
+
+#ifdef TASK_MATRIX_STATS
+void recordMatrixAllocation(size_t bytes);
+#else
+inline void recordMatrixAllocation(size_t) {}
+#endif
+
+}  // namespace task
@@ -0,0 +1,70 @@
+#include <functional>
+#include "matrix_view.h"
+
+using namespace task;
+
+template<class T>
+BasicMatrixView<T>::BasicMatrixView(const T *data, size_t rows, size_t cols, size_t row_stride, size_t col_stride)
+    : values(data), n_rows(rows), n_cols(cols), row_stride(row_stride), col_stride(col_stride) {}
+
+template<class T>
+BasicMatrixView<T>::BasicMatrixView(const BasicMatrix<T> &matrix) : BasicMatrixView(matrix.view()) {}
+
+template<class T>
+const T &BasicMatrixView<T>::get(size_t row, size_t col) const {
+  if (row >= this->n_rows or col >= this->n_cols)
+    throw OutOfBoundsException();
+  else
+    return this->values[row * this->row_stride + col * this->col_stride];
+}
+
+template<class T>
+bool BasicMatrixView<T>::overlaps(const void *begin, const void *end) const {
+  if (this->n_rows == 0 or this->n_cols == 0)
+    return false;
+  const T *last = this->values + (this->n_rows - 1) * this->row_stride + (this->n_cols - 1) * this->col_stride;
+  std::less<const void *> less;
+
+  return less(this->values, end) and !less(last, begin);
+}
+
+template<class T>
+BasicMatrixView<T> BasicMatrixView<T>::transposedView() const {
+  return BasicMatrixView<T>(this->values, this->n_cols, this->n_rows, this->col_stride, this->row_stride);
+}
+
+template<class T>
+BasicMatrixView<T> BasicMatrixView<T>::row(size_t row) const { return block(row, 0, 1, this->n_cols); }
+
+template<class T>
+BasicMatrixView<T> BasicMatrixView<T>::column(size_t column) const { return block(0, column, this->n_rows, 1); }
+
+template<class T>
+BasicMatrixView<T> BasicMatrixView<T>::block(size_t row, size_t col, size_t rows, size_t cols) const {
+  if (rows == 0 or cols == 0 or row + rows > this->n_rows or col + cols > this->n_cols)
+    throw OutOfBoundsException();
+  else
+    return BasicMatrixView<T>(this->values + row * this->row_stride + col * this->col_stride, rows, cols,
+                              this->row_stride, this->col_stride);
+}
+
+template<class T>
+const T *BasicMatrixView<T>::data() const { return this->values; }
+
+template<class T>
+size_t BasicMatrixView<T>::getRowStride() const { return this->row_stride; }
+
+template<class T>
+size_t BasicMatrixView<T>::getColStride() const { return this->col_stride; }
+
+template<class T>
+size_t BasicMatrixView<T>::getNumRows() const { return this->n_rows; }
+
+template<class T>
+size_t BasicMatrixView<T>::getNumCols() const { return this->n_cols; }
+
+template class task::BasicMatrixView<float>;
+template class task::BasicMatrixView<double>;
+template class task::BasicMatrixView<long double>;
+template class task::BasicMatrixView<int>;
+template class task::BasicMatrixView<long>;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "matrix.h"
+
+namespace task {
+
+// Read-only strided window into matrix storage: element (i, j) is data[i * row_stride + j * col_stride].
+// A transposed view swaps the strides, a row or column is a 1 x n or n x 1 view, and a block keeps
+// the parent strides, so none of them copies. Views take part in element-wise expressions, products
+// and det() like a Matrix and are only read when the result is computed.
+template<class T>
+class BasicMatrixView : public MatrixExpr<BasicMatrixView<T>> {
+ public:
+  typedef T value_type;
+
+  BasicMatrixView(const T *data, size_t rows, size_t cols, size_t row_stride, size_t col_stride);
+  BasicMatrixView(const BasicMatrix<T> &matrix);
+
+  const T &get(size_t row, size_t col) const;
+  T at(size_t row, size_t col) const { return this->values[row * this->row_stride + col * this->col_stride]; }
+  bool overlaps(const void *begin, const void *end) const;
+
+  BasicMatrixView transposedView() const;
+  BasicMatrixView row(size_t row) const;
+  BasicMatrixView column(size_t column) const;
+  BasicMatrixView block(size_t row, size_t col, size_t rows, size_t cols) const;
+
+  const T *data() const;
+  size_t getRowStride() const;
+  size_t getColStride() const;
+  size_t getNumCols() const;
+  size_t getNumRows() const;
+
+ private:
+  const T *values;
+  size_t n_rows;
+  size_t n_cols;
+  size_t row_stride;
+  size_t col_stride;
+};
+
+// Matrices and views are multiplied in place; any other expression is evaluated first.
+template<class E>
+struct ProductOperand {
+  BasicMatrix<typename E::value_type> value;
+  BasicMatrixView<typename E::value_type> view;
+
+  explicit ProductOperand(const E &expr) : value(expr), view(value) {}
+};
+
+template<class T>
+struct ProductOperand<BasicMatrix<T>> {
+  BasicMatrixView<T> view;
+
+  explicit ProductOperand(const BasicMatrix<T> &matrix) : view(matrix) {}
+};
+
+template<class T>
+struct ProductOperand<BasicMatrixView<T>> {
+  BasicMatrixView<T> view;
+
+  explicit ProductOperand(const BasicMatrixView<T> &view) : view(view) {}
+};
+
+template<class L, class R>
+BasicMatrix<typename L::value_type> operator*(const MatrixExpr<L> &a, const MatrixExpr<R> &b) {
+  static_assert(std::is_same<typename L::value_type, typename R::value_type>::value,
+                "factors of a product must have the same element type");
+  return BasicMatrix<typename L::value_type>::multiply(ProductOperand<L>(a.self()).view,
+                                                       ProductOperand<R>(b.self()).view);
+}
+
+}  // namespace task
@@ -0,0 +1,130 @@
+#include <cmath>
+#include "qr.h"
+#include "gemm.h"
+
+using namespace task;
+
+QRDecomposition::QRDecomposition(const Matrix &a) : qr(a), tau(a.getNumCols()), full_rank(true) {
+  size_t m = a.getNumRows();
+  size_t n = a.getNumCols();
+
+  if (m < n)
+    throw SizeMismatchException();
+
+  for (size_t k = 0; k < n; ++k) {
+    double alpha = this->qr[k][k];
+    double sigma = 0.;
+    for (size_t i = k + 1; i < m; ++i)
+      sigma += this->qr[i][k] * this->qr[i][k];
+
+    if (sigma == 0.) {
+      // Column is already zero below the diagonal: H_k = I.
+      this->tau[k] = 0.;
+    } else {
+      double norm = std::sqrt(alpha * alpha + sigma);
+      double beta = alpha > 0. ? -norm : norm;
+      double scale = 1. / (alpha - beta);
+      this->tau[k] = (beta - alpha) / beta;
+      for (size_t i = k + 1; i < m; ++i)
+        this->qr[i][k] *= scale;
+      this->qr[k][k] = beta;
+      apply_reflector(k, this->qr, k + 1);
+    }
+    if (this->qr[k][k] == 0.)
+      this->full_rank = false;
+  }
+}
+
+// b = H_k b on columns [from_col, cols): w = v^T b, then b -= tau v w, both passes along rows.
+void QRDecomposition::apply_reflector(size_t k, Matrix &b, size_t from_col) const {
+  size_t m = getNumRows();
+  size_t cols = b.getNumCols();
+
+  if (this->tau[k] == 0. or from_col >= cols)
+    return;
+
+  std::vector<double> w(b[k] + from_col, b[k] + cols);
+  for (size_t i = k + 1; i < m; ++i) {
+    const double v = this->qr[i][k];
+    const double *row = b[i];
+#pragma GCC ivdep
+    for (size_t j = from_col; j < cols; ++j)
+      w[j - from_col] += v * row[j];
+  }
+
+  const double tau = this->tau[k];
+  double *row_k = b[k];
+#pragma GCC ivdep
+  for (size_t j = from_col; j < cols; ++j)
+    row_k[j] -= tau * w[j - from_col];
+  for (size_t i = k + 1; i < m; ++i) {
+    const double v = tau * this->qr[i][k];
+    double *row = b[i];
+#pragma GCC ivdep
+    for (size_t j = from_col; j < cols; ++j)
+      row[j] -= v * w[j - from_col];
+  }
+}
+
+// Solves R x = b in the first n rows of b.
+void QRDecomposition::back_substitute(Matrix &b) const {
+  trsm(false, false, getNumCols(), b.getNumCols(), this->qr[0], this->qr.view().getRowStride(), 1, b[0],
+       b.view().getRowStride());
+}
+
+size_t QRDecomposition::getNumRows() const { return this->qr.getNumRows(); }
+
+size_t QRDecomposition::getNumCols() const { return this->qr.getNumCols(); }
+
+bool QRDecomposition::isFullRank() const { return this->full_rank; }
+
+Matrix QRDecomposition::getQ() const {
+  Matrix q(getNumRows(), getNumCols());
+
+  // Q = H_0 H_1 ... H_{n-1} I, applied from the last reflector so each touches only its columns.
+  for (size_t k = getNumCols(); k-- > 0;)
+    apply_reflector(k, q, k);
+  return q;
+}
+
+Matrix QRDecomposition::getR() const {
+  size_t n = getNumCols();
+  Matrix r(n, n);
+
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      r[i][j] = j < i ? 0. : this->qr[i][j];
+  return r;
+}
+
+std::vector<double> QRDecomposition::solve(const std::vector<double> &b) const {
+  Matrix column(b.size(), 1);
+
+  for (size_t i = 0; i < b.size(); ++i)
+    column[i][0] = b[i];
+  return solve(column).getColumn(0);
+}
+
+Matrix QRDecomposition::solve(const Matrix &b) const {
+  if (b.getNumRows() != getNumRows())
+    throw SizeMismatchException();
+  else if (!this->full_rank)
+    throw SingularMatrixException();
+
+  size_t n = getNumCols();
+  Matrix y(b);
+
+  for (size_t k = 0; k < n; ++k)
+    apply_reflector(k, y, 0);
+  back_substitute(y);
+  if (getNumRows() != n)
+    y.resize(n, y.getNumCols());
+  return y;
+}
+
+Matrix QRDecomposition::inverse() const {
+  if (getNumRows() != getNumCols())
+    throw SizeMismatchException();
+  else
+    return solve(Matrix(getNumRows(), getNumCols()));
+}
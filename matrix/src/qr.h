@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// A = QR by Householder reflections for an m x n A with m >= n, computed once and reused by
+// every solve(). R sits on and above the diagonal, the reflectors H_k = I - tau_k v_k v_k^T below
+// it with the leading 1 of v_k implied, as in LAPACK's geqrf. For m > n solve() returns the
+// least-squares solution.
+class QRDecomposition {
+ public:
+  explicit QRDecomposition(const Matrix &a);
+
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+  bool isFullRank() const;
+
+  // Thin factors: Q is m x n with orthonormal columns, R is n x n upper triangular.
+  Matrix getQ() const;
+  Matrix getR() const;
+
+  // Minimize |A x - b|; throw SingularMatrixException when R has a zero on its diagonal.
+  std::vector<double> solve(const std::vector<double> &b) const;
+  Matrix solve(const Matrix &b) const;
+  // Square A only.
+  Matrix inverse() const;
+
+ private:
+  Matrix qr;
+  std::vector<double> tau;
+  bool full_rank;
+
+  void apply_reflector(size_t k, Matrix &b, size_t from_col) const;
+  void back_substitute(Matrix &b) const;
+};
+
+}  // namespace task
@@ -0,0 +1,542 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TASK_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace task;
+
+namespace {
+
+struct RowKernels {
+  void (*add)(double *, const double *, size_t);
+  void (*sub)(double *, const double *, size_t);
+  void (*scale)(double *, double, size_t);
+  bool (*equal)(const double *, const double *, size_t, double);
+  void (*axpy)(double *, double, const double *, size_t);
+  double (*dot)(const double *, const double *, size_t);
+  void (*add_float)(float *, const float *, size_t);
+  void (*sub_float)(float *, const float *, size_t);
+  void (*scale_float)(float *, float, size_t);
+  bool (*equal_float)(const float *, const float *, size_t, float);
+};
+
+void add_scalar(double *dst, const double *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] += src[i];
+}
+
+void sub_scalar(double *dst, const double *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] -= src[i];
+}
+
+void scale_scalar(double *dst, double factor, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] *= factor;
+}
+
+bool equal_scalar(const double *a, const double *b, size_t n, double eps) {
+  for (size_t i = 0; i < n; ++i)
+    if (std::fabs(a[i] - b[i]) > eps)
+      return false;
+  return true;
+}
+
+// axpy must not be contracted into an FMA, which GCC does by default wherever the target has one
+// (-march=native, or AVX-512F below); the kernels keep it off so every level rounds the same way.
+__attribute__((optimize("fp-contract=off")))
+void axpy_scalar(double *dst, double factor, const double *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] += factor * src[i];
+}
+
+double dot_scalar(const double *a, const double *b, size_t n) {
+  double sum = 0.;
+  for (size_t i = 0; i < n; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+void add_float_scalar(float *dst, const float *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] += src[i];
+}
+
+void sub_float_scalar(float *dst, const float *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] -= src[i];
+}
+
+void scale_float_scalar(float *dst, float factor, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] *= factor;
+}
+
+bool equal_float_scalar(const float *a, const float *b, size_t n, float eps) {
+  for (size_t i = 0; i < n; ++i)
+    if (std::fabs(a[i] - b[i]) > eps)
+      return false;
+  return true;
+}
+
+#ifdef TASK_SIMD_X86
+
+void add_sse2(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+  add_scalar(dst + i, src + i, n - i);
+}
+
+void sub_sse2(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_pd(dst + i, _mm_sub_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+  sub_scalar(dst + i, src + i, n - i);
+}
+
+void scale_sse2(double *dst, double factor, size_t n) {
+  const __m128d f = _mm_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(dst + i), f));
+  scale_scalar(dst + i, factor, n - i);
+}
+
+bool equal_sse2(const double *a, const double *b, size_t n, double eps) {
+  const __m128d e = _mm_set1_pd(eps);
+  const __m128d sign = _mm_set1_pd(-0.);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d diff = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    if (_mm_movemask_pd(_mm_cmpgt_pd(diff, e)))
+      return false;
+  }
+  return equal_scalar(a + i, b + i, n - i, eps);
+}
+
+__attribute__((optimize("fp-contract=off")))
+void axpy_sse2(double *dst, double factor, const double *src, size_t n) {
+  const __m128d f = _mm_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_mul_pd(f, _mm_loadu_pd(src + i))));
+  axpy_scalar(dst + i, factor, src + i, n - i);
+}
+
+// Two independent accumulators hide the latency of the additions.
+double dot_sse2(const double *a, const double *b, size_t n) {
+  __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+  __m128d sum = _mm_add_pd(sum0, sum1);
+  return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum))) + dot_scalar(a + i, b + i, n - i);
+}
+
+void add_float_sse2(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+  add_float_scalar(dst + i, src + i, n - i);
+}
+
+void sub_float_sse2(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm_sub_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+  sub_float_scalar(dst + i, src + i, n - i);
+}
+
+void scale_float_sse2(float *dst, float factor, size_t n) {
+  const __m128 f = _mm_set1_ps(factor);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), f));
+  scale_float_scalar(dst + i, factor, n - i);
+}
+
+bool equal_float_sse2(const float *a, const float *b, size_t n, float eps) {
+  const __m128 e = _mm_set1_ps(eps);
+  const __m128 sign = _mm_set1_ps(-0.f);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 diff = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    if (_mm_movemask_ps(_mm_cmpgt_ps(diff, e)))
+      return false;
+  }
+  return equal_float_scalar(a + i, b + i, n - i, eps);
+}
+
+__attribute__((target("avx2")))
+void add_avx2(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+  add_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void sub_avx2(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+  sub_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void scale_avx2(double *dst, double factor, size_t n) {
+  const __m256d f = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(dst + i), f));
+  scale_scalar(dst + i, factor, n - i);
+}
+
+// Tests 16 elements per branch; _CMP_GT_OQ is false for NaN, like the scalar fabs(a - b) > eps.
+__attribute__((target("avx2")))
+bool equal_avx2(const double *a, const double *b, size_t n, double eps) {
+  const __m256d e = _mm256_set1_pd(eps);
+  const __m256d sign = _mm256_set1_pd(-0.);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256d mismatch = _mm256_setzero_pd();
+    for (size_t j = 0; j < 16; j += 4) {
+      __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(a + i + j), _mm256_loadu_pd(b + i + j)));
+      mismatch = _mm256_or_pd(mismatch, _mm256_cmp_pd(diff, e, _CMP_GT_OQ));
+    }
+    if (_mm256_movemask_pd(mismatch))
+      return false;
+  }
+  for (; i + 4 <= n; i += 4) {
+    __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    if (_mm256_movemask_pd(_mm256_cmp_pd(diff, e, _CMP_GT_OQ)))
+      return false;
+  }
+  return equal_scalar(a + i, b + i, n - i, eps);
+}
+
+__attribute__((target("avx2"), optimize("fp-contract=off")))
+void axpy_avx2(double *dst, double factor, const double *src, size_t n) {
+  const __m256d f = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_mul_pd(f, _mm256_loadu_pd(src + i))));
+  axpy_scalar(dst + i, factor, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+double dot_avx2(const double *a, const double *b, size_t n) {
+  __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+  }
+  __m256d sum = _mm256_add_pd(sum0, sum1);
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half))) + dot_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void add_float_avx2(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+  add_float_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void sub_float_avx2(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_sub_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+  sub_float_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+void scale_float_avx2(float *dst, float factor, size_t n) {
+  const __m256 f = _mm256_set1_ps(factor);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), f));
+  scale_float_scalar(dst + i, factor, n - i);
+}
+
+__attribute__((target("avx2")))
+bool equal_float_avx2(const float *a, const float *b, size_t n, float eps) {
+  const __m256 e = _mm256_set1_ps(eps);
+  const __m256 sign = _mm256_set1_ps(-0.f);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256 mismatch = _mm256_setzero_ps();
+    for (size_t j = 0; j < 32; j += 8) {
+      __m256 diff = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_loadu_ps(a + i + j), _mm256_loadu_ps(b + i + j)));
+      mismatch = _mm256_or_ps(mismatch, _mm256_cmp_ps(diff, e, _CMP_GT_OQ));
+    }
+    if (_mm256_movemask_ps(mismatch))
+      return false;
+  }
+  for (; i + 8 <= n; i += 8) {
+    __m256 diff = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    if (_mm256_movemask_ps(_mm256_cmp_ps(diff, e, _CMP_GT_OQ)))
+      return false;
+  }
+  return equal_float_scalar(a + i, b + i, n - i, eps);
+}
+
+__attribute__((target("avx512f")))
+void add_avx512(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+  if (i < n) {
+    __mmask8 tail = (__mmask8) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_pd(dst + i, tail, _mm512_add_pd(_mm512_maskz_loadu_pd(tail, dst + i),
+                                                       _mm512_maskz_loadu_pd(tail, src + i)));
+  }
+}
+
+__attribute__((target("avx512f")))
+void sub_avx512(double *dst, const double *src, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(dst + i, _mm512_sub_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+  if (i < n) {
+    __mmask8 tail = (__mmask8) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_pd(dst + i, tail, _mm512_sub_pd(_mm512_maskz_loadu_pd(tail, dst + i),
+                                                       _mm512_maskz_loadu_pd(tail, src + i)));
+  }
+}
+
+__attribute__((target("avx512f")))
+void scale_avx512(double *dst, double factor, size_t n) {
+  const __m512d f = _mm512_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_loadu_pd(dst + i), f));
+  if (i < n) {
+    __mmask8 tail = (__mmask8) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_pd(dst + i, tail, _mm512_mul_pd(_mm512_maskz_loadu_pd(tail, dst + i), f));
+  }
+}
+
+__attribute__((target("avx512f")))
+bool equal_avx512(const double *a, const double *b, size_t n, double eps) {
+  const __m512d e = _mm512_set1_pd(eps);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __mmask8 mismatch = 0;
+    for (size_t j = 0; j < 32; j += 8) {
+      __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(a + i + j), _mm512_loadu_pd(b + i + j)));
+      mismatch |= _mm512_cmp_pd_mask(diff, e, _CMP_GT_OQ);
+    }
+    if (mismatch)
+      return false;
+  }
+  for (; i < n; i += 8) {
+    __mmask8 tail = n - i >= 8 ? (__mmask8) 0xFF : (__mmask8) ((1u << (n - i)) - 1);
+    __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i)));
+    if (_mm512_mask_cmp_pd_mask(tail, diff, e, _CMP_GT_OQ))
+      return false;
+  }
+  return true;
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+void axpy_avx512(double *dst, double factor, const double *src, size_t n) {
+  const __m512d f = _mm512_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8)
+    _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_mul_pd(f, _mm512_loadu_pd(src + i))));
+  if (i < n) {
+    __mmask8 tail = (__mmask8) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_pd(dst + i, tail, _mm512_add_pd(_mm512_maskz_loadu_pd(tail, dst + i),
+                                                       _mm512_mul_pd(f, _mm512_maskz_loadu_pd(tail, src + i))));
+  }
+}
+
+__attribute__((target("avx512f")))
+double dot_avx512(const double *a, const double *b, size_t n) {
+  __m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), sum0);
+    sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), sum1);
+  }
+  for (; i < n; i += 8) {
+    __mmask8 tail = n - i >= 8 ? (__mmask8) 0xFF : (__mmask8) ((1u << (n - i)) - 1);
+    sum0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i), sum0);
+  }
+  // Reduced by hand: in GCC _mm512_reduce_add_pd, _mm512_castpd512_pd256 and _mm512_extractf64x4_pd
+  // merge into an undefined register and trip -Wuninitialized; the zero-masking extract does not.
+  __m512d sum = _mm512_add_pd(sum0, sum1);
+  __m256d quarter = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, sum, 0),
+                                  _mm512_maskz_extractf64x4_pd(0xF, sum, 1));
+  __m128d half = _mm_add_pd(_mm256_castpd256_pd128(quarter), _mm256_extractf128_pd(quarter, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx512f")))
+void add_float_avx512(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), _mm512_loadu_ps(src + i)));
+  if (i < n) {
+    __mmask16 tail = (__mmask16) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_ps(dst + i, tail, _mm512_add_ps(_mm512_maskz_loadu_ps(tail, dst + i),
+                                                       _mm512_maskz_loadu_ps(tail, src + i)));
+  }
+}
+
+__attribute__((target("avx512f")))
+void sub_float_avx512(float *dst, const float *src, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(dst + i, _mm512_sub_ps(_mm512_loadu_ps(dst + i), _mm512_loadu_ps(src + i)));
+  if (i < n) {
+    __mmask16 tail = (__mmask16) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_ps(dst + i, tail, _mm512_sub_ps(_mm512_maskz_loadu_ps(tail, dst + i),
+                                                       _mm512_maskz_loadu_ps(tail, src + i)));
+  }
+}
+
+__attribute__((target("avx512f")))
+void scale_float_avx512(float *dst, float factor, size_t n) {
+  const __m512 f = _mm512_set1_ps(factor);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+    _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(dst + i), f));
+  if (i < n) {
+    __mmask16 tail = (__mmask16) ((1u << (n - i)) - 1);
+    _mm512_mask_storeu_ps(dst + i, tail, _mm512_mul_ps(_mm512_maskz_loadu_ps(tail, dst + i), f));
+  }
+}
+
+__attribute__((target("avx512f")))
+bool equal_float_avx512(const float *a, const float *b, size_t n, float eps) {
+  const __m512 e = _mm512_set1_ps(eps);
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __mmask16 mismatch = 0;
+    for (size_t j = 0; j < 64; j += 16) {
+      __m512 diff = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(a + i + j), _mm512_loadu_ps(b + i + j)));
+      mismatch |= _mm512_cmp_ps_mask(diff, e, _CMP_GT_OQ);
+    }
+    if (mismatch)
+      return false;
+  }
+  for (; i < n; i += 16) {
+    __mmask16 tail = n - i >= 16 ? (__mmask16) 0xFFFF : (__mmask16) ((1u << (n - i)) - 1);
+    __m512 diff = _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i)));
+    if (_mm512_mask_cmp_ps_mask(tail, diff, e, _CMP_GT_OQ))
+      return false;
+  }
+  return true;
+}
+
+#endif
+
+const RowKernels SCALAR_KERNELS = {add_scalar, sub_scalar, scale_scalar, equal_scalar, axpy_scalar, dot_scalar,
+                                   add_float_scalar, sub_float_scalar, scale_float_scalar, equal_float_scalar};
+#ifdef TASK_SIMD_X86
+const RowKernels SSE2_KERNELS = {add_sse2, sub_sse2, scale_sse2, equal_sse2, axpy_sse2, dot_sse2,
+                                 add_float_sse2, sub_float_sse2, scale_float_sse2, equal_float_sse2};
+const RowKernels AVX2_KERNELS = {add_avx2, sub_avx2, scale_avx2, equal_avx2, axpy_avx2, dot_avx2,
+                                 add_float_avx2, sub_float_avx2, scale_float_avx2, equal_float_avx2};
+const RowKernels AVX512_KERNELS = {add_avx512, sub_avx512, scale_avx512, equal_avx512, axpy_avx512, dot_avx512,
+                                   add_float_avx512, sub_float_avx512, scale_float_avx512, equal_float_avx512};
+#endif
+
+const RowKernels *kernels_for(SimdLevel level) {
+  switch (level) {
+#ifdef TASK_SIMD_X86
+    case SimdLevel::AVX512:
+      return &AVX512_KERNELS;
+    case SimdLevel::AVX2:
+      return &AVX2_KERNELS;
+    case SimdLevel::SSE2:
+      return &SSE2_KERNELS;
+#endif
+    default:
+      return &SCALAR_KERNELS;
+  }
+}
+
+// Null until the first call, so kernels used during static initialization still dispatch.
+std::atomic<const RowKernels *> active_kernels(nullptr);
+std::atomic<SimdLevel> active_level(SimdLevel::SCALAR);
+
+SimdLevel detected_level() {
+  static const SimdLevel level = detectSimdLevel();
+  return level;
+}
+
+const RowKernels *kernels() {
+  const RowKernels *current = active_kernels.load();
+  if (current == nullptr) {
+    active_level = detected_level();
+    current = kernels_for(detected_level());
+    active_kernels = current;
+  }
+  return current;
+}
+
+}  // namespace
+
+SimdLevel task::detectSimdLevel() {
+#ifdef TASK_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return SimdLevel::AVX512;
+  else if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::AVX2;
+  else if (__builtin_cpu_supports("sse2"))
+    return SimdLevel::SSE2;
+#endif
+  return SimdLevel::SCALAR;
+}
+
+SimdLevel task::getSimdLevel() {
+  kernels();
+  return active_level;
+}
+
+void task::setSimdLevel(SimdLevel level) {
+  level = std::min(level, detected_level());
+  active_level = level;
+  active_kernels = kernels_for(level);
+}
+
+void task::vectorAdd(double *dst, const double *src, size_t n) { kernels()->add(dst, src, n); }
+
+void task::vectorSub(double *dst, const double *src, size_t n) { kernels()->sub(dst, src, n); }
+
+void task::vectorScale(double *dst, double factor, size_t n) { kernels()->scale(dst, factor, n); }
+
+bool task::vectorEqual(const double *a, const double *b, size_t n, double eps) {
+  return kernels()->equal(a, b, n, eps);
+}
+
+void task::vectorAxpy(double *dst, double factor, const double *src, size_t n) {
+  kernels()->axpy(dst, factor, src, n);
+}
+
+double task::vectorDot(const double *a, const double *b, size_t n) { return kernels()->dot(a, b, n); }
+
+void task::vectorAdd(float *dst, const float *src, size_t n) { kernels()->add_float(dst, src, n); }
+
+void task::vectorSub(float *dst, const float *src, size_t n) { kernels()->sub_float(dst, src, n); }
+
+void task::vectorScale(float *dst, float factor, size_t n) { kernels()->scale_float(dst, factor, n); }
+
+bool task::vectorEqual(const float *a, const float *b, size_t n, float eps) {
+  return kernels()->equal_float(a, b, n, eps);
+}
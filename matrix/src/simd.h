@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+
+namespace task {
+
+// Instruction sets of the element-wise row kernels. The best one the CPU supports is picked
+// at the first call; setSimdLevel can force a lower one (a higher one is clamped).
+enum class SimdLevel { SCALAR, SSE2, AVX2, AVX512 };
+
+SimdLevel detectSimdLevel();
+SimdLevel getSimdLevel();
+void setSimdLevel(SimdLevel level);
+
+// dst[i] += src[i], dst[i] -= src[i] and dst[i] *= factor for i < n.
+void vectorAdd(double *dst, const double *src, size_t n);
+void vectorSub(double *dst, const double *src, size_t n);
+void vectorScale(double *dst, double factor, size_t n);
+
+// Whether |a[i] - b[i]| <= eps for every i < n; stops at the first block with a mismatch.
+bool vectorEqual(const double *a, const double *b, size_t n, double eps);
+
+// dst[i] += factor * src[i] and the dot product of a and b for i < n; the building blocks of the
+// matrix-vector kernels (gemm.h). axpy is never contracted into an FMA, so it rounds every element
+// the same way at every level and under any -march. Dot products sum in per-lane partials, fused
+// multiply-adds at AVX-512, so the last bits of the result depend on the SimdLevel.
+void vectorAxpy(double *dst, double factor, const double *src, size_t n);
+double vectorDot(const double *a, const double *b, size_t n);
+
+// The same for float rows, dispatched on the same SimdLevel.
+void vectorAdd(float *dst, const float *src, size_t n);
+void vectorSub(float *dst, const float *src, size_t n);
+void vectorScale(float *dst, float factor, size_t n);
+bool vectorEqual(const float *a, const float *b, size_t n, float eps);
+
+// Portable loops for the remaining element types (long double and integers).
+template<class T>
+void vectorAdd(T *dst, const T *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] += src[i];
+}
+
+template<class T>
+void vectorSub(T *dst, const T *src, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] -= src[i];
+}
+
+template<class T>
+void vectorScale(T *dst, T factor, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] *= factor;
+}
+
+template<class T>
+bool vectorEqual(const T *a, const T *b, size_t n, T eps) {
+  for (size_t i = 0; i < n; ++i)
+    if ((a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]) > eps)
+      return false;
+  return true;
+}
+
+}  // namespace task
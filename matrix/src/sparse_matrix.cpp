@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cmath>
+#include "sparse_matrix.h"
+#include "thread_pool.h"
+
+using namespace task;
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, Format format)
+    : n_rows(rows), n_cols(cols), format(format) {
+  if (rows == 0 or cols == 0)
+    throw OutOfBoundsException();
+  this->offsets.assign(major_size() + 1, 0);
+}
+
+SparseMatrix::SparseMatrix(const Matrix &dense, Format format, double tolerance)
+    : SparseMatrix(dense.getNumRows(), dense.getNumCols(), format) {
+  for (size_t line = 0; line < major_size(); ++line) {
+    for (size_t pos = 0; pos < minor_size(); ++pos) {
+      double value = format == Format::CSR ? dense[line][pos] : dense[pos][line];
+      if (std::fabs(value) > tolerance) {
+        this->indices.push_back(pos);
+        this->values.push_back(value);
+      }
+    }
+    this->offsets[line + 1] = this->indices.size();
+  }
+}
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, const std::vector<SparseEntry> &entries, Format format)
+    : SparseMatrix(rows, cols, format) {
+  std::vector<size_t> order(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (entries[i].row >= rows or entries[i].col >= cols)
+      throw OutOfBoundsException();
+    order[i] = i;
+  }
+
+  auto major = [&](const SparseEntry &e) { return format == Format::CSR ? e.row : e.col; };
+  auto minor = [&](const SparseEntry &e) { return format == Format::CSR ? e.col : e.row; };
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return std::make_pair(major(entries[a]), minor(entries[a])) < std::make_pair(major(entries[b]), minor(entries[b]));
+  });
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    const SparseEntry &entry = entries[order[i]];
+    bool duplicate = i > 0 and major(entries[order[i - 1]]) == major(entry)
+        and minor(entries[order[i - 1]]) == minor(entry);
+    if (duplicate) {
+      this->values.back() += entry.value;
+    } else {
+      this->indices.push_back(minor(entry));
+      this->values.push_back(entry.value);
+      ++this->offsets[major(entry) + 1];
+    }
+  }
+  for (size_t line = 0; line < major_size(); ++line)
+    this->offsets[line + 1] += this->offsets[line];
+}
+
+Matrix SparseMatrix::toDense() const {
+  Matrix dense(this->n_rows, this->n_cols);
+
+  for (size_t i = 0; i < std::min(this->n_rows, this->n_cols); ++i)
+    dense[i][i] = 0.;
+  for (size_t line = 0; line < major_size(); ++line)
+    for (size_t k = this->offsets[line]; k < this->offsets[line + 1]; ++k) {
+      if (this->format == Format::CSR)
+        dense[line][this->indices[k]] = this->values[k];
+      else
+        dense[this->indices[k]][line] = this->values[k];
+    }
+  return dense;
+}
+
+SparseMatrix SparseMatrix::toFormat(Format format) const {
+  if (format == this->format)
+    return *this;
+
+  // Counting sort of the nonzeros by their minor index turns the lines inside out.
+  SparseMatrix result(this->n_rows, this->n_cols, format);
+  result.indices.resize(getNumNonZeros());
+  result.values.resize(getNumNonZeros());
+
+  for (size_t k = 0; k < getNumNonZeros(); ++k)
+    ++result.offsets[this->indices[k] + 1];
+  for (size_t line = 0; line < result.major_size(); ++line)
+    result.offsets[line + 1] += result.offsets[line];
+
+  std::vector<size_t> next(result.offsets.begin(), result.offsets.end() - 1);
+  for (size_t line = 0; line < major_size(); ++line)
+    for (size_t k = this->offsets[line]; k < this->offsets[line + 1]; ++k) {
+      size_t dst = next[this->indices[k]]++;
+      result.indices[dst] = line;
+      result.values[dst] = this->values[k];
+    }
+  return result;
+}
+
+SparseMatrix SparseMatrix::transposed() const {
+  SparseMatrix result(*this);
+
+  std::swap(result.n_rows, result.n_cols);
+  result.format = this->format == Format::CSR ? Format::CSC : Format::CSR;
+  return result;
+}
+
+double SparseMatrix::get(size_t row, size_t col) const {
+  if (row >= this->n_rows or col >= this->n_cols)
+    throw OutOfBoundsException();
+
+  size_t line = this->format == Format::CSR ? row : col;
+  size_t pos = this->format == Format::CSR ? col : row;
+  auto begin = this->indices.begin() + this->offsets[line];
+  auto end = this->indices.begin() + this->offsets[line + 1];
+  auto it = std::lower_bound(begin, end, pos);
+
+  if (it != end and *it == pos)
+    return this->values[it - this->indices.begin()];
+  else
+    return 0.;
+}
+
+void SparseMatrix::merge(const SparseMatrix &a, double sign) {
+  if (a.n_rows != this->n_rows or a.n_cols != this->n_cols)
+    throw SizeMismatchException();
+  if (a.format != this->format) {
+    merge(a.toFormat(this->format), sign);
+    return;
+  }
+
+  std::vector<size_t> new_offsets(major_size() + 1, 0);
+  std::vector<size_t> new_indices;
+  std::vector<double> new_values;
+  new_indices.reserve(getNumNonZeros() + a.getNumNonZeros());
+  new_values.reserve(getNumNonZeros() + a.getNumNonZeros());
+
+  auto push = [&](size_t index, double value) {
+    if (value != 0.) {
+      new_indices.push_back(index);
+      new_values.push_back(value);
+    }
+  };
+
+  for (size_t line = 0; line < major_size(); ++line) {
+    size_t i = this->offsets[line], i_end = this->offsets[line + 1];
+    size_t j = a.offsets[line], j_end = a.offsets[line + 1];
+    while (i < i_end or j < j_end) {
+      if (j == j_end or (i < i_end and this->indices[i] < a.indices[j])) {
+        push(this->indices[i], this->values[i]);
+        ++i;
+      } else if (i == i_end or a.indices[j] < this->indices[i]) {
+        push(a.indices[j], sign * a.values[j]);
+        ++j;
+      } else {
+        push(this->indices[i], this->values[i] + sign * a.values[j]);
+        ++i;
+        ++j;
+      }
+    }
+    new_offsets[line + 1] = new_indices.size();
+  }
+
+  this->offsets.swap(new_offsets);
+  this->indices.swap(new_indices);
+  this->values.swap(new_values);
+}
+
+SparseMatrix &SparseMatrix::operator+=(const SparseMatrix &a) {
+  merge(a, 1.);
+  return *this;
+}
+
+SparseMatrix &SparseMatrix::operator-=(const SparseMatrix &a) {
+  merge(a, -1.);
+  return *this;
+}
+
+SparseMatrix &SparseMatrix::operator*=(const double &number) {
+  if (number == 0.) {
+    std::fill(this->offsets.begin(), this->offsets.end(), 0);
+    this->indices.clear();
+    this->values.clear();
+  } else {
+    for (double &value : this->values)
+      value *= number;
+  }
+  return *this;
+}
+
+SparseMatrix SparseMatrix::operator+(const SparseMatrix &a) const {
+  SparseMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+SparseMatrix SparseMatrix::operator-(const SparseMatrix &a) const {
+  SparseMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+SparseMatrix SparseMatrix::operator*(const double &number) const {
+  SparseMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+SparseMatrix SparseMatrix::operator-() const { return *this * -1.; }
+
+std::vector<size_t> SparseMatrix::balanced_lines(size_t n_parts) const {
+  std::vector<size_t> bounds(1, 0);
+
+  for (size_t part = 1; part < n_parts; ++part) {
+    size_t target = getNumNonZeros() * part / n_parts;
+    size_t line = std::lower_bound(this->offsets.begin(), this->offsets.end(), target) - this->offsets.begin();
+    line = std::min(line, major_size());
+    if (line > bounds.back())
+      bounds.push_back(line);
+  }
+  if (bounds.back() != major_size())
+    bounds.push_back(major_size());
+  return bounds;
+}
+
+void SparseMatrix::multiply(const double *x, double *y) const {
+  if (this->format == Format::CSC) {
+    std::fill(y, y + this->n_rows, 0.);
+    for (size_t col = 0; col < this->n_cols; ++col)
+      for (size_t k = this->offsets[col]; k < this->offsets[col + 1]; ++k)
+        y[this->indices[k]] += this->values[k] * x[col];
+    return;
+  }
+
+  auto rows = [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; ++row) {
+      double sum = 0.;
+      for (size_t k = this->offsets[row]; k < this->offsets[row + 1]; ++k)
+        sum += this->values[k] * x[this->indices[k]];
+      y[row] = sum;
+    }
+  };
+
+  ThreadPool &pool = defaultThreadPool();
+  if (getNumNonZeros() < SPARSE_PARALLEL_CUTOFF or pool.getNumThreads() == 1) {
+    rows(0, this->n_rows);
+    return;
+  }
+  std::vector<size_t> bounds = balanced_lines(4 * pool.getNumThreads());
+  pool.parallelFor(bounds.size() - 1, [&](size_t part) { rows(bounds[part], bounds[part + 1]); });
+}
+
+std::vector<double> SparseMatrix::operator*(const std::vector<double> &x) const {
+  if (x.size() != this->n_cols)
+    throw SizeMismatchException();
+
+  std::vector<double> y(this->n_rows);
+  multiply(x.data(), y.data());
+  return y;
+}
+
+Matrix SparseMatrix::operator*(const Matrix &b) const {
+  if (b.getNumRows() != this->n_cols)
+    throw SizeMismatchException();
+  else if (this->format == Format::CSC)
+    return toFormat(Format::CSR) * b;
+
+  size_t n = b.getNumCols();
+  Matrix result(this->n_rows, n);
+  for (size_t i = 0; i < std::min(this->n_rows, n); ++i)
+    result[i][i] = 0.;
+
+  auto rows = [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; ++row) {
+      double *out = result[row];
+      for (size_t k = this->offsets[row]; k < this->offsets[row + 1]; ++k) {
+        const double value = this->values[k];
+        const double *b_row = b[this->indices[k]];
+        for (size_t j = 0; j < n; ++j)
+          out[j] += value * b_row[j];
+      }
+    }
+  };
+
+  ThreadPool &pool = defaultThreadPool();
+  if (getNumNonZeros() * n < SPARSE_PARALLEL_CUTOFF or pool.getNumThreads() == 1) {
+    rows(0, this->n_rows);
+  } else {
+    std::vector<size_t> bounds = balanced_lines(4 * pool.getNumThreads());
+    pool.parallelFor(bounds.size() - 1, [&](size_t part) { rows(bounds[part], bounds[part + 1]); });
+  }
+  return result;
+}
+
+SparseMatrix::Format SparseMatrix::getFormat() const { return this->format; }
+
+size_t SparseMatrix::getNumRows() const { return this->n_rows; }
+
+size_t SparseMatrix::getNumCols() const { return this->n_cols; }
+
+size_t SparseMatrix::getNumNonZeros() const { return this->values.size(); }
+
+size_t SparseMatrix::major_size() const { return this->format == Format::CSR ? this->n_rows : this->n_cols; }
+
+size_t SparseMatrix::minor_size() const { return this->format == Format::CSR ? this->n_cols : this->n_rows; }
+
+SparseMatrix task::operator*(const double &number, const SparseMatrix &a) { return a * number; }
+
+// A B = (B^T A^T)^T, and B^T in CSR is B in CSC reinterpreted, so the sparse x dense kernel does the work.
+Matrix task::operator*(const Matrix &a, const SparseMatrix &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+
+  return (b.transposed() * a.transposed()).transposed();
+}
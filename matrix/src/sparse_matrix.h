@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// Products touching fewer nonzeros run on the calling thread.
+const size_t SPARSE_PARALLEL_CUTOFF = 1 << 15;
+
+struct SparseEntry {
+  size_t row;
+  size_t col;
+  double value;
+};
+
+// Compressed sparse matrix: CSR keeps the nonzeros of each row contiguous, CSC those of each column.
+// offsets[l]..offsets[l + 1] index the nonzeros of line l (a row for CSR, a column for CSC), whose
+// positions along the other dimension are stored sorted in indices. Memory is O(lines + nonzeros).
+class SparseMatrix {
+ public:
+  enum class Format { CSR, CSC };
+
+  SparseMatrix(size_t rows, size_t cols, Format format = Format::CSR);
+  // Entries with |value| <= tolerance are dropped.
+  explicit SparseMatrix(const Matrix &dense, Format format = Format::CSR, double tolerance = 0.);
+  // Duplicate positions are summed.
+  SparseMatrix(size_t rows, size_t cols, const std::vector<SparseEntry> &entries, Format format = Format::CSR);
+
+  Matrix toDense() const;
+  SparseMatrix toFormat(Format format) const;
+  // Reinterprets CSR as CSC of the transpose and vice versa, without touching the nonzeros.
+  SparseMatrix transposed() const;
+
+  double get(size_t row, size_t col) const;
+
+  SparseMatrix &operator+=(const SparseMatrix &a);
+  SparseMatrix &operator-=(const SparseMatrix &a);
+  SparseMatrix &operator*=(const double &number);
+
+  SparseMatrix operator+(const SparseMatrix &a) const;
+  SparseMatrix operator-(const SparseMatrix &a) const;
+  SparseMatrix operator*(const double &number) const;
+  SparseMatrix operator-() const;
+
+  // y = A x without allocating; CSR rows are split over defaultThreadPool() by nonzero count.
+  void multiply(const double *x, double *y) const;
+  std::vector<double> operator*(const std::vector<double> &x) const;
+  Matrix operator*(const Matrix &b) const;
+
+  Format getFormat() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+  size_t getNumNonZeros() const;
+
+ private:
+  size_t n_rows;
+  size_t n_cols;
+  Format format;
+  std::vector<size_t> offsets;
+  std::vector<size_t> indices;
+  std::vector<double> values;
+
+  size_t major_size() const;
+  size_t minor_size() const;
+  void merge(const SparseMatrix &a, double sign);
+  // Splits the lines into at most n_parts ranges of roughly equal nonzero count.
+  std::vector<size_t> balanced_lines(size_t n_parts) const;
+};
+
+SparseMatrix operator*(const double &number, const SparseMatrix &a);
+Matrix operator*(const Matrix &a, const SparseMatrix &b);
+
+}  // namespace task
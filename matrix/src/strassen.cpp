@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include "strassen.h"
+#include "gemm.h"
+#include "matrix.h"
+
+using namespace task;
+
+namespace {
+
+std::atomic<bool> strassen_enabled(false);
+std::atomic<size_t> strassen_crossover(STRASSEN_CROSSOVER);
+
+void add(size_t m, size_t n, const double *a, size_t lda, const double *b, size_t ldb, double *c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i)
+    for (size_t j = 0; j < n; ++j)
+      c[i * ldc + j] = a[i * lda + j] + b[i * ldb + j];
+}
+
+void sub(size_t m, size_t n, const double *a, size_t lda, const double *b, size_t ldb, double *c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i)
+    for (size_t j = 0; j < n; ++j)
+      c[i * ldc + j] = a[i * lda + j] - b[i * ldb + j];
+}
+
+void zero(size_t m, size_t n, double *c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i)
+    std::fill(c + i * ldc, c + i * ldc + n, 0.);
+}
+
+bool is_base_case(size_t m, size_t n, size_t k, size_t crossover) {
+  return m <= crossover or n <= crossover or k <= crossover;
+}
+
+// Doubles of workspace needed below a product of this shape: the X and Y temporaries of
+// this level plus the workspace shared by its seven half-size products.
+size_t workspace_size(size_t m, size_t n, size_t k, size_t crossover) {
+  if (is_base_case(m, n, k, crossover))
+    return 0;
+
+  size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+  return m2 * std::max(k2, n2) + k2 * n2 + workspace_size(m2, n2, k2, crossover);
+}
+
+// C = A * B following the Boyer-Dumas-Pernet-Zhou schedule, which needs only two temporaries:
+// X (S blocks, then P1) and Y (T blocks); the other products are built in the quadrants of C.
+void strassen_recursive(size_t m, size_t n, size_t k,
+                        const double *a, size_t lda,
+                        const double *b, size_t ldb,
+                        double *c, size_t ldc,
+                        double *workspace, size_t crossover) {
+  if (is_base_case(m, n, k, crossover)) {
+    zero(m, n, c, ldc);
+    gemm(m, n, k, a, lda, b, ldb, c, ldc);
+    return;
+  }
+
+  size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+  const double *a11 = a, *a12 = a + k2, *a21 = a + m2 * lda, *a22 = a21 + k2;
+  const double *b11 = b, *b12 = b + n2, *b21 = b + k2 * ldb, *b22 = b21 + n2;
+  double *c11 = c, *c12 = c + n2, *c21 = c + m2 * ldc, *c22 = c21 + n2;
+  double *x = workspace;
+  double *y = x + m2 * std::max(k2, n2);
+  double *next = y + k2 * n2;
+
+  sub(m2, k2, a11, lda, a21, lda, x, k2);                                  // S3
+  sub(k2, n2, b22, ldb, b12, ldb, y, n2);                                  // T3
+  strassen_recursive(m2, n2, k2, x, k2, y, n2, c21, ldc, next, crossover);  // P7
+  add(m2, k2, a21, lda, a22, lda, x, k2);                                  // S1
+  sub(k2, n2, b12, ldb, b11, ldb, y, n2);                                  // T1
+  strassen_recursive(m2, n2, k2, x, k2, y, n2, c22, ldc, next, crossover);  // P5
+  sub(m2, k2, x, k2, a11, lda, x, k2);                                     // S2
+  sub(k2, n2, b22, ldb, y, n2, y, n2);                                     // T2
+  strassen_recursive(m2, n2, k2, x, k2, y, n2, c12, ldc, next, crossover);  // P6
+  sub(m2, k2, a12, lda, x, k2, x, k2);                                     // S4
+  strassen_recursive(m2, n2, k2, x, k2, b22, ldb, c11, ldc, next, crossover);  // P3
+  strassen_recursive(m2, n2, k2, a11, lda, b11, ldb, x, n2, next, crossover);  // P1
+  add(m2, n2, x, n2, c12, ldc, c12, ldc);                                  // U2 = P1 + P6
+  add(m2, n2, c12, ldc, c21, ldc, c21, ldc);                               // U3 = U2 + P7
+  add(m2, n2, c12, ldc, c22, ldc, c12, ldc);                               // U4 = U2 + P5
+  add(m2, n2, c21, ldc, c22, ldc, c22, ldc);                               // U7 = U3 + P5
+  add(m2, n2, c12, ldc, c11, ldc, c12, ldc);                               // U5 = U4 + P3
+  sub(k2, n2, y, n2, b21, ldb, y, n2);                                     // T4
+  strassen_recursive(m2, n2, k2, a22, lda, y, n2, c11, ldc, next, crossover);  // P4
+  sub(m2, n2, c21, ldc, c11, ldc, c21, ldc);                               // U6 = U3 - P4
+  strassen_recursive(m2, n2, k2, a12, lda, b21, ldb, c11, ldc, next, crossover);  // P2
+  add(m2, n2, x, n2, c11, ldc, c11, ldc);                                  // U1 = P1 + P2
+
+  size_t me = 2 * m2, ne = 2 * n2, ke = 2 * k2;
+  if (ke != k)
+    gemm(me, ne, k - ke, a + ke, lda, b + ke * ldb, ldb, c, ldc);
+  if (ne != n) {
+    zero(me, n - ne, c + ne, ldc);
+    gemm(me, n - ne, k, a, lda, b + ne, ldb, c + ne, ldc);
+  }
+  if (me != m) {
+    zero(m - me, n, c + me * ldc, ldc);
+    gemm(m - me, n, k, a + me * lda, lda, b, ldb, c + me * ldc, ldc);
+  }
+}
+
+}  // namespace
+
+void task::setStrassenEnabled(bool enabled) { strassen_enabled = enabled; }
+
+bool task::isStrassenEnabled() { return strassen_enabled; }
+
+void task::setStrassenCrossover(size_t crossover) { strassen_crossover = std::max<size_t>(crossover, 1); }
+
+size_t task::getStrassenCrossover() { return strassen_crossover; }
+
+void task::strassen(size_t m, size_t n, size_t k,
+                    const double *a, size_t lda,
+                    const double *b, size_t ldb,
+                    double *c, size_t ldc) {
+  size_t crossover = strassen_crossover;
+  size_t size = workspace_size(m, n, k, crossover);
+  double *workspace = size == 0 ? nullptr : new(std::align_val_t(ALIGNMENT)) double[size];
+
+  strassen_recursive(m, n, k, a, lda, b, ldb, c, ldc, workspace, crossover);
+
+  ::operator delete[](workspace, std::align_val_t(ALIGNMENT));
+}
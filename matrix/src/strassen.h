@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace task {
+
+// Strassen-Winograd multiplication (7 products and 15 additions per level) for very large products.
+//
+// It is off by default. Once enabled, Matrix::operator* recurses while every dimension of the
+// current product is above the crossover, then hands the blocks to gemm. Odd dimensions are
+// peeled off and finished with thin gemm calls.
+//
+// Error bounds: the classical kernel satisfies the componentwise bound
+//   |C - fl(AB)| <= k u |A| |B|    (u = 2^-53).
+// Strassen-Winograd only satisfies a normwise one: after l levels with n0 = n / 2^l,
+//   ||C - fl(AB)|| <= c (n0^2 + 5 n0) 18^l u ||A|| ||B||,
+// so each level can multiply the worst-case error by about 18, against a factor of 2 for the
+// classical bound. Entries much smaller than ||A|| ||B|| may lose all their relative accuracy.
+// Keep it for well-scaled operands whose entries are of similar magnitude and use a crossover
+// of at least 1000 (one or two levels) where accuracy matters.
+const size_t STRASSEN_CROSSOVER = 1024;
+
+void setStrassenEnabled(bool enabled);
+bool isStrassenEnabled();
+void setStrassenCrossover(size_t crossover);
+size_t getStrassenCrossover();
+
+// C = A * B (C is overwritten) for row-major A (m x k), B (k x n) and C (m x n). The workspace for
+// the whole recursion is allocated once per call.
+void strassen(size_t m, size_t n, size_t k,
+              const double *a, size_t lda,
+              const double *b, size_t ldb,
+              double *c, size_t ldc);
+
+}  // namespace task
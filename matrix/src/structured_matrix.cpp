@@ -0,0 +1,882 @@
+#include <algorithm>
+#include <cmath>
+#include "gemm.h"
+#include "simd.h"
+#include "structured_matrix.h"
+#include "thread_pool.h"
+
+using namespace task;
+
+namespace {
+
+// Element (row, col), col <= row, of a triangle packed row by row.
+size_t packed_index(size_t row, size_t col) { return row * (row + 1) / 2 + col; }
+
+size_t packed_size(size_t size) { return size * (size + 1) / 2; }
+
+size_t checked_size(size_t size) {
+  if (size == 0)
+    throw OutOfBoundsException();
+  return size;
+}
+
+size_t square_size(const Matrix &dense) {
+  if (dense.getNumRows() != dense.getNumCols())
+    throw SizeMismatchException();
+  return dense.getNumRows();
+}
+
+// Matrix(rows, cols) starts as the identity.
+Matrix zero_matrix(size_t rows, size_t cols) {
+  Matrix result(rows, cols);
+
+  for (size_t i = 0; i < std::min(rows, cols); ++i)
+    result[i][i] = 0.;
+  return result;
+}
+
+// Rows [first, first + rows) and columns [from, to) of a packed matrix as a dense row-major panel
+// with leading dimension ld: lower takes (i, j), j <= i, from packed row i and upper takes (i, j),
+// j >= i, from packed row j; every other element is zero.
+void unpack_panel(const std::vector<double> &values, bool lower, bool upper, size_t first, size_t rows,
+                  size_t from, size_t to, double *panel, size_t ld) {
+  for (size_t r = 0; r < rows; ++r) {
+    size_t i = first + r;
+    std::fill(panel + r * ld, panel + r * ld + to - from, 0.);
+    if (lower and i >= from)
+      std::copy(values.begin() + packed_index(i, from), values.begin() + packed_index(i, std::min(i + 1, to)),
+                panel + r * ld);
+  }
+  // Walking j outside reads every packed row j once, in storage order.
+  for (size_t j = std::max(first, from); upper and j < to; ++j)
+    for (size_t r = 0; r < rows and first + r <= j; ++r)
+      panel[r * ld + j - from] = values[packed_index(j, first + r)];
+}
+
+// Cholesky factor L of a packed symmetric matrix, in place and row by row: L(i, j) takes the dot
+// product of packed rows i and j over their first j elements, both contiguous. Rows go in blocks of
+// STRUCTURED_BLOCK, every earlier row is read once per block, and the rows of a block are split over
+// the thread pool. Returns false, leaving l partly factored, when the matrix is not positive definite.
+bool packed_cholesky(std::vector<double> &l, size_t n) {
+  for (size_t i0 = 0; i0 < n; i0 += STRUCTURED_BLOCK) {
+    size_t rows = std::min(STRUCTURED_BLOCK, n - i0);
+    parallelForRanges(rows, rows * i0 * i0 / 2, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+      for (size_t j = 0; j < i0; ++j) {
+        const double *row_j = l.data() + packed_index(j, 0);
+        for (size_t i = i0 + begin; i < i0 + end; ++i) {
+          double *row_i = l.data() + packed_index(i, 0);
+          row_i[j] = (row_i[j] - vectorDot(row_i, row_j, j)) / row_j[j];
+        }
+      }
+    });
+
+    for (size_t i = i0; i < i0 + rows; ++i) {
+      double *row_i = l.data() + packed_index(i, 0);
+      for (size_t j = i0; j < i; ++j) {
+        const double *row_j = l.data() + packed_index(j, 0);
+        row_i[j] = (row_i[j] - vectorDot(row_i, row_j, j)) / row_j[j];
+      }
+      double diagonal = row_i[i] - vectorDot(row_i, row_i, i);
+      if (!(diagonal > 0.))
+        return false;
+      row_i[i] = std::sqrt(diagonal);
+    }
+  }
+  return true;
+}
+
+// Symmetric swap of rows and columns p < q of the trailing submatrix [k, n) of a packed lower triangle.
+void packed_swap(std::vector<double> &a, size_t n, size_t k, size_t p, size_t q) {
+  std::swap(a[packed_index(p, p)], a[packed_index(q, q)]);
+  std::swap_ranges(a.begin() + packed_index(p, k), a.begin() + packed_index(p, p), a.begin() + packed_index(q, k));
+  for (size_t j = p + 1; j < q; ++j)
+    std::swap(a[packed_index(j, p)], a[packed_index(q, j)]);
+  for (size_t i = q + 1; i < n; ++i)
+    std::swap(a[packed_index(i, p)], a[packed_index(i, q)]);
+}
+
+// Determinant of a packed symmetric matrix by LDL^T with Bunch-Kaufman pivoting, as LAPACK's sptrf:
+// symmetric swaps leave the determinant alone, so it is the product of the 1 x 1 and 2 x 2 blocks
+// of D, and L is never kept. Each step updates the packed rows of the trailing submatrix by axpys
+// with the pivot columns gathered into contiguous vectors. Destroys a.
+double packed_ldlt_det(std::vector<double> &a, size_t n) {
+  const double alpha = (1. + std::sqrt(17.)) / 8.;
+  std::vector<double> w1(n), w2(n);
+  double det = 1.;
+
+  for (size_t k = 0; k < n;) {
+    double diagonal = std::fabs(a[packed_index(k, k)]);
+    size_t r = k;
+    double col_max = 0.;
+    for (size_t i = k + 1; i < n; ++i)
+      if (std::fabs(a[packed_index(i, k)]) > col_max) {
+        col_max = std::fabs(a[packed_index(i, k)]);
+        r = i;
+      }
+    if (diagonal == 0. and col_max == 0.)
+      return 0.;
+
+    size_t step = 1;
+    if (diagonal < alpha * col_max) {
+      double row_max = 0.;
+      for (size_t j = k; j < n; ++j)
+        if (j != r)
+          row_max = std::max(row_max, std::fabs(a[j < r ? packed_index(r, j) : packed_index(j, r)]));
+      if (diagonal * row_max >= alpha * col_max * col_max) {
+        // Keep the 1 x 1 pivot at k.
+      } else if (std::fabs(a[packed_index(r, r)]) >= alpha * row_max)
+        packed_swap(a, n, k, k, r);
+      else {
+        step = 2;
+        if (r != k + 1)
+          packed_swap(a, n, k, k + 1, r);
+      }
+    }
+
+    if (step == 1) {
+      double d = a[packed_index(k, k)];
+      det *= d;
+      for (size_t i = k + 1; i < n; ++i)
+        w1[i] = a[packed_index(i, k)];
+      for (size_t i = k + 1; i < n; ++i)
+        vectorAxpy(a.data() + packed_index(i, k + 1), -w1[i] / d, w1.data() + k + 1, i - k);
+    } else {
+      double d11 = a[packed_index(k, k)], d21 = a[packed_index(k + 1, k)], d22 = a[packed_index(k + 1, k + 1)];
+      double block_det = d11 * d22 - d21 * d21;
+      det *= block_det;
+      for (size_t i = k + 2; i < n; ++i) {
+        w1[i] = a[packed_index(i, k)];
+        w2[i] = a[packed_index(i, k + 1)];
+      }
+      // Row i of the update is (w1[i], w2[i]) D^-1 times the columns (w1, w2).
+      for (size_t i = k + 2; i < n; ++i) {
+        double y1 = (d22 * w1[i] - d21 * w2[i]) / block_det;
+        double y2 = (d11 * w2[i] - d21 * w1[i]) / block_det;
+        double *row = a.data() + packed_index(i, k + 2);
+        vectorAxpy(row, -y1, w1.data() + k + 2, i - k - 1);
+        vectorAxpy(row, -y2, w2.data() + k + 2, i - k - 1);
+      }
+    }
+    k += step;
+  }
+  return det;
+}
+
+}  // namespace
+
+SymmetricMatrix::SymmetricMatrix(size_t size) : size(checked_size(size)), values(packed_size(size), 0.) {}
+
+SymmetricMatrix::SymmetricMatrix(const Matrix &dense) : SymmetricMatrix(square_size(dense)) {
+  for (size_t i = 0; i < this->size; ++i)
+    std::copy(dense[i], dense[i] + i + 1, this->values.begin() + packed_index(i, 0));
+}
+
+Matrix SymmetricMatrix::toDense() const {
+  Matrix dense(this->size, this->size);
+  size_t stride = dense.view().getRowStride();
+
+  for (size_t first = 0; first < this->size; first += STRUCTURED_BLOCK)
+    unpack_panel(this->values, true, true, first, std::min(STRUCTURED_BLOCK, this->size - first), 0, this->size,
+                 dense[first], stride);
+  return dense;
+}
+
+SymmetricMatrix SymmetricMatrix::transposed() const { return *this; }
+
+double SymmetricMatrix::get(size_t row, size_t col) const {
+  if (row >= this->size or col >= this->size)
+    throw OutOfBoundsException();
+  else
+    return this->values[packed_index(std::max(row, col), std::min(row, col))];
+}
+
+void SymmetricMatrix::set(size_t row, size_t col, const double &value) {
+  if (row >= this->size or col >= this->size)
+    throw OutOfBoundsException();
+  else
+    this->values[packed_index(std::max(row, col), std::min(row, col))] = value;
+}
+
+SymmetricMatrix &SymmetricMatrix::operator+=(const SymmetricMatrix &a) {
+  if (a.size != this->size)
+    throw SizeMismatchException();
+
+  vectorAdd(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+SymmetricMatrix &SymmetricMatrix::operator-=(const SymmetricMatrix &a) {
+  if (a.size != this->size)
+    throw SizeMismatchException();
+
+  vectorSub(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+SymmetricMatrix &SymmetricMatrix::operator*=(const double &number) {
+  vectorScale(this->values.data(), number, this->values.size());
+  return *this;
+}
+
+SymmetricMatrix SymmetricMatrix::operator+(const SymmetricMatrix &a) const {
+  SymmetricMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+SymmetricMatrix SymmetricMatrix::operator-(const SymmetricMatrix &a) const {
+  SymmetricMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+SymmetricMatrix SymmetricMatrix::operator*(const double &number) const {
+  SymmetricMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+SymmetricMatrix SymmetricMatrix::operator-() const { return *this * -1.; }
+
+// Row i of the packed triangle is both the left part of row i and the upper part of column i.
+void SymmetricMatrix::multiply(const double *x, double *y) const {
+  std::fill(y, y + this->size, 0.);
+  for (size_t i = 0; i < this->size; ++i) {
+    const double *row = this->values.data() + packed_index(i, 0);
+    y[i] += vectorDot(row, x, i) + row[i] * x[i];
+    vectorAxpy(y, x[i], row, i);
+  }
+}
+
+std::vector<double> SymmetricMatrix::operator*(const std::vector<double> &x) const {
+  if (x.size() != this->size)
+    throw SizeMismatchException();
+
+  std::vector<double> y(this->size);
+  multiply(x.data(), y.data());
+  return y;
+}
+
+Matrix SymmetricMatrix::operator*(const Matrix &b) const {
+  if (b.getNumRows() != this->size)
+    throw SizeMismatchException();
+
+  size_t n = b.getNumCols();
+  size_t b_stride = b.view().getRowStride();
+  Matrix result = zero_matrix(this->size, n);
+  size_t stride = result.view().getRowStride();
+  size_t n_blocks = (this->size + STRUCTURED_BLOCK - 1) / STRUCTURED_BLOCK;
+  parallelForRanges(n_blocks, this->size * this->size * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    std::vector<double> panel(STRUCTURED_BLOCK * this->size);
+    for (size_t block = begin; block < end; ++block) {
+      size_t first = block * STRUCTURED_BLOCK, rows = std::min(STRUCTURED_BLOCK, this->size - first);
+      unpack_panel(this->values, true, true, first, rows, 0, this->size, panel.data(), this->size);
+      gemm(rows, n, this->size, panel.data(), this->size, b[0], b_stride, result[first], stride);
+    }
+  });
+  return result;
+}
+
+double SymmetricMatrix::det() const {
+  std::vector<double> factor(this->values);
+
+  if (packed_cholesky(factor, this->size)) {
+    double det = 1.;
+    for (size_t i = 0; i < this->size; ++i)
+      det *= factor[packed_index(i, i)];
+    return det * det;
+  }
+  factor = this->values;
+  return packed_ldlt_det(factor, this->size);
+}
+
+double SymmetricMatrix::trace() const {
+  double trace = 0.;
+
+  for (size_t i = 0; i < this->size; ++i)
+    trace += this->values[packed_index(i, i)];
+  return trace;
+}
+
+size_t SymmetricMatrix::getNumRows() const { return this->size; }
+
+size_t SymmetricMatrix::getNumCols() const { return this->size; }
+
+TriangularMatrix::TriangularMatrix(size_t size, Triangle triangle)
+    : size(checked_size(size)), triangle(triangle), values(packed_size(size), 0.) {}
+
+TriangularMatrix::TriangularMatrix(const Matrix &dense, Triangle triangle)
+    : TriangularMatrix(square_size(dense), triangle) {
+  for (size_t i = 0; i < this->size; ++i)
+    for (size_t j = 0; j <= i; ++j)
+      this->values[packed_index(i, j)] = triangle == Triangle::Lower ? dense[i][j] : dense[j][i];
+}
+
+Matrix TriangularMatrix::toDense() const {
+  Matrix dense(this->size, this->size);
+  size_t stride = dense.view().getRowStride();
+  bool lower = this->triangle == Triangle::Lower;
+
+  for (size_t first = 0; first < this->size; first += STRUCTURED_BLOCK)
+    unpack_panel(this->values, lower, !lower, first, std::min(STRUCTURED_BLOCK, this->size - first), 0, this->size,
+                 dense[first], stride);
+  return dense;
+}
+
+TriangularMatrix TriangularMatrix::transposed() const {
+  TriangularMatrix result(*this);
+
+  result.triangle = this->triangle == Triangle::Lower ? Triangle::Upper : Triangle::Lower;
+  return result;
+}
+
+bool TriangularMatrix::stored(size_t row, size_t col) const {
+  return this->triangle == Triangle::Lower ? col <= row : row <= col;
+}
+
+double TriangularMatrix::get(size_t row, size_t col) const {
+  if (row >= this->size or col >= this->size)
+    throw OutOfBoundsException();
+  else if (!stored(row, col))
+    return 0.;
+  else
+    return this->values[packed_index(std::max(row, col), std::min(row, col))];
+}
+
+void TriangularMatrix::set(size_t row, size_t col, const double &value) {
+  if (row >= this->size or col >= this->size or !stored(row, col))
+    throw OutOfBoundsException();
+  else
+    this->values[packed_index(std::max(row, col), std::min(row, col))] = value;
+}
+
+TriangularMatrix &TriangularMatrix::operator+=(const TriangularMatrix &a) {
+  if (a.size != this->size or a.triangle != this->triangle)
+    throw SizeMismatchException();
+
+  vectorAdd(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+TriangularMatrix &TriangularMatrix::operator-=(const TriangularMatrix &a) {
+  if (a.size != this->size or a.triangle != this->triangle)
+    throw SizeMismatchException();
+
+  vectorSub(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+TriangularMatrix &TriangularMatrix::operator*=(const double &number) {
+  vectorScale(this->values.data(), number, this->values.size());
+  return *this;
+}
+
+TriangularMatrix TriangularMatrix::operator+(const TriangularMatrix &a) const {
+  TriangularMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+TriangularMatrix TriangularMatrix::operator-(const TriangularMatrix &a) const {
+  TriangularMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+TriangularMatrix TriangularMatrix::operator*(const double &number) const {
+  TriangularMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+TriangularMatrix TriangularMatrix::operator-() const { return *this * -1.; }
+
+// Packed row i is row i of a lower matrix and column i of an upper one, so the lower product takes
+// dot products and the upper one accumulates columns.
+void TriangularMatrix::multiply(const double *x, double *y) const {
+  if (this->triangle == Triangle::Lower) {
+    for (size_t i = 0; i < this->size; ++i)
+      y[i] = vectorDot(this->values.data() + packed_index(i, 0), x, i + 1);
+  } else {
+    std::fill(y, y + this->size, 0.);
+    for (size_t j = 0; j < this->size; ++j)
+      vectorAxpy(y, x[j], this->values.data() + packed_index(j, 0), j + 1);
+  }
+}
+
+std::vector<double> TriangularMatrix::operator*(const std::vector<double> &x) const {
+  if (x.size() != this->size)
+    throw SizeMismatchException();
+
+  std::vector<double> y(this->size);
+  multiply(x.data(), y.data());
+  return y;
+}
+
+Matrix TriangularMatrix::operator*(const Matrix &b) const {
+  if (b.getNumRows() != this->size)
+    throw SizeMismatchException();
+
+  // A block of lower rows ends at its last diagonal element and a block of upper rows starts at its
+  // first, so gemm skips the zero triangle except inside the block.
+  size_t n = b.getNumCols();
+  size_t b_stride = b.view().getRowStride();
+  Matrix result = zero_matrix(this->size, n);
+  size_t stride = result.view().getRowStride();
+  size_t n_blocks = (this->size + STRUCTURED_BLOCK - 1) / STRUCTURED_BLOCK;
+  bool lower = this->triangle == Triangle::Lower;
+  parallelForRanges(n_blocks, packed_size(this->size) * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    std::vector<double> panel(STRUCTURED_BLOCK * this->size);
+    for (size_t block = begin; block < end; ++block) {
+      size_t first = block * STRUCTURED_BLOCK, rows = std::min(STRUCTURED_BLOCK, this->size - first);
+      size_t from = lower ? 0 : first, to = lower ? first + rows : this->size;
+      unpack_panel(this->values, lower, !lower, first, rows, from, to, panel.data(), to - from);
+      gemm(rows, n, to - from, panel.data(), to - from, b[from], b_stride, result[first], stride);
+    }
+  });
+  return result;
+}
+
+// Row i of L1 L2 is the sum of L1(i, k) times row k of L2 for k <= i, and every such row ends at
+// column k <= i, so the product is accumulated in the packed rows directly. U1 U2 = (U2^T U1^T)^T.
+TriangularMatrix TriangularMatrix::operator*(const TriangularMatrix &b) const {
+  if (b.size != this->size or b.triangle != this->triangle)
+    throw SizeMismatchException();
+  else if (this->triangle == Triangle::Upper)
+    return (b.transposed() * transposed()).transposed();
+
+  TriangularMatrix result(this->size, Triangle::Lower);
+  size_t volume = this->size * packed_size(this->size) / 3;
+  parallelForRanges(this->size, volume, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      double *out = result.values.data() + packed_index(i, 0);
+      for (size_t k = 0; k <= i; ++k)
+        vectorAxpy(out, this->values[packed_index(i, k)], b.values.data() + packed_index(k, 0), k + 1);
+    }
+  });
+  return result;
+}
+
+double TriangularMatrix::det() const {
+  double det = 1.;
+
+  for (size_t i = 0; i < this->size; ++i)
+    det *= this->values[packed_index(i, i)];
+  return det;
+}
+
+double TriangularMatrix::trace() const {
+  double trace = 0.;
+
+  for (size_t i = 0; i < this->size; ++i)
+    trace += this->values[packed_index(i, i)];
+  return trace;
+}
+
+TriangularMatrix::Triangle TriangularMatrix::getTriangle() const { return this->triangle; }
+
+size_t TriangularMatrix::getNumRows() const { return this->size; }
+
+size_t TriangularMatrix::getNumCols() const { return this->size; }
+
+DiagonalMatrix::DiagonalMatrix(size_t size) : values(checked_size(size), 0.) {}
+
+DiagonalMatrix::DiagonalMatrix(const std::vector<double> &diagonal) : values(diagonal) {
+  checked_size(diagonal.size());
+}
+
+DiagonalMatrix::DiagonalMatrix(const Matrix &dense) : DiagonalMatrix(square_size(dense)) {
+  for (size_t i = 0; i < this->values.size(); ++i)
+    this->values[i] = dense[i][i];
+}
+
+Matrix DiagonalMatrix::toDense() const {
+  Matrix dense(this->values.size(), this->values.size());
+
+  for (size_t i = 0; i < this->values.size(); ++i)
+    dense[i][i] = this->values[i];
+  return dense;
+}
+
+DiagonalMatrix DiagonalMatrix::transposed() const { return *this; }
+
+double DiagonalMatrix::get(size_t row, size_t col) const {
+  if (row >= this->values.size() or col >= this->values.size())
+    throw OutOfBoundsException();
+  else
+    return row == col ? this->values[row] : 0.;
+}
+
+void DiagonalMatrix::set(size_t row, size_t col, const double &value) {
+  if (row >= this->values.size() or row != col)
+    throw OutOfBoundsException();
+  else
+    this->values[row] = value;
+}
+
+DiagonalMatrix &DiagonalMatrix::operator+=(const DiagonalMatrix &a) {
+  if (a.values.size() != this->values.size())
+    throw SizeMismatchException();
+
+  vectorAdd(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+DiagonalMatrix &DiagonalMatrix::operator-=(const DiagonalMatrix &a) {
+  if (a.values.size() != this->values.size())
+    throw SizeMismatchException();
+
+  vectorSub(this->values.data(), a.values.data(), this->values.size());
+  return *this;
+}
+
+DiagonalMatrix &DiagonalMatrix::operator*=(const double &number) {
+  vectorScale(this->values.data(), number, this->values.size());
+  return *this;
+}
+
+DiagonalMatrix DiagonalMatrix::operator+(const DiagonalMatrix &a) const {
+  DiagonalMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+DiagonalMatrix DiagonalMatrix::operator-(const DiagonalMatrix &a) const {
+  DiagonalMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+DiagonalMatrix DiagonalMatrix::operator*(const double &number) const {
+  DiagonalMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+DiagonalMatrix DiagonalMatrix::operator-() const { return *this * -1.; }
+
+void DiagonalMatrix::multiply(const double *x, double *y) const {
+  const double *d = this->values.data();
+#pragma GCC ivdep
+  for (size_t i = 0; i < this->values.size(); ++i)
+    y[i] = d[i] * x[i];
+}
+
+std::vector<double> DiagonalMatrix::operator*(const std::vector<double> &x) const {
+  if (x.size() != this->values.size())
+    throw SizeMismatchException();
+
+  std::vector<double> y(this->values.size());
+  multiply(x.data(), y.data());
+  return y;
+}
+
+Matrix DiagonalMatrix::operator*(const Matrix &b) const {
+  if (b.getNumRows() != this->values.size())
+    throw SizeMismatchException();
+
+  Matrix result(b);
+  for (size_t i = 0; i < this->values.size(); ++i)
+    vectorScale(result[i], this->values[i], result.getNumCols());
+  return result;
+}
+
+DiagonalMatrix DiagonalMatrix::operator*(const DiagonalMatrix &b) const {
+  if (b.values.size() != this->values.size())
+    throw SizeMismatchException();
+
+  DiagonalMatrix result(this->values.size());
+  multiply(b.values.data(), result.values.data());
+  return result;
+}
+
+double DiagonalMatrix::det() const {
+  double det = 1.;
+
+  for (double value : this->values)
+    det *= value;
+  return det;
+}
+
+double DiagonalMatrix::trace() const {
+  double trace = 0.;
+
+  for (double value : this->values)
+    trace += value;
+  return trace;
+}
+
+const std::vector<double> &DiagonalMatrix::getDiagonal() const { return this->values; }
+
+size_t DiagonalMatrix::getNumRows() const { return this->values.size(); }
+
+size_t DiagonalMatrix::getNumCols() const { return this->values.size(); }
+
+BandMatrix::BandMatrix(size_t size, size_t bandwidth)
+    : size(checked_size(size)), bandwidth(std::min(bandwidth, size - 1)), values(size * width(), 0.) {}
+
+BandMatrix::BandMatrix(const Matrix &dense, size_t bandwidth) : BandMatrix(square_size(dense), bandwidth) {
+  for (size_t i = 0; i < this->size; ++i)
+    std::copy(dense[i] + first_col(i), dense[i] + last_col(i) + 1,
+              this->values.begin() + i * width() + first_col(i) + this->bandwidth - i);
+}
+
+size_t BandMatrix::width() const { return 2 * this->bandwidth + 1; }
+
+size_t BandMatrix::first_col(size_t row) const { return row > this->bandwidth ? row - this->bandwidth : 0; }
+
+size_t BandMatrix::last_col(size_t row) const { return std::min(this->size - 1, row + this->bandwidth); }
+
+Matrix BandMatrix::toDense() const {
+  Matrix dense = zero_matrix(this->size, this->size);
+
+  for (size_t i = 0; i < this->size; ++i)
+    for (size_t j = first_col(i); j <= last_col(i); ++j)
+      dense[i][j] = this->values[i * width() + j + this->bandwidth - i];
+  return dense;
+}
+
+BandMatrix BandMatrix::transposed() const {
+  BandMatrix result(this->size, this->bandwidth);
+
+  for (size_t i = 0; i < this->size; ++i)
+    for (size_t j = first_col(i); j <= last_col(i); ++j)
+      result.values[j * width() + i + this->bandwidth - j] = this->values[i * width() + j + this->bandwidth - i];
+  return result;
+}
+
+double BandMatrix::get(size_t row, size_t col) const {
+  if (row >= this->size or col >= this->size)
+    throw OutOfBoundsException();
+  else if (col < first_col(row) or col > last_col(row))
+    return 0.;
+  else
+    return this->values[row * width() + col + this->bandwidth - row];
+}
+
+void BandMatrix::set(size_t row, size_t col, const double &value) {
+  if (row >= this->size or col < first_col(row) or col > last_col(row))
+    throw OutOfBoundsException();
+  else
+    this->values[row * width() + col + this->bandwidth - row] = value;
+}
+
+BandMatrix BandMatrix::widened(size_t new_bandwidth) const {
+  BandMatrix result(this->size, new_bandwidth);
+  size_t shift = result.bandwidth - this->bandwidth;
+
+  for (size_t i = 0; i < this->size; ++i)
+    std::copy(this->values.begin() + i * width(), this->values.begin() + (i + 1) * width(),
+              result.values.begin() + i * result.width() + shift);
+  return result;
+}
+
+void BandMatrix::merge(const BandMatrix &a, double sign) {
+  if (a.size != this->size)
+    throw SizeMismatchException();
+  if (a.bandwidth > this->bandwidth)
+    *this = widened(a.bandwidth);
+  else if (a.bandwidth < this->bandwidth) {
+    merge(a.widened(this->bandwidth), sign);
+    return;
+  }
+
+  if (sign > 0.)
+    vectorAdd(this->values.data(), a.values.data(), this->values.size());
+  else
+    vectorSub(this->values.data(), a.values.data(), this->values.size());
+}
+
+BandMatrix &BandMatrix::operator+=(const BandMatrix &a) {
+  merge(a, 1.);
+  return *this;
+}
+
+BandMatrix &BandMatrix::operator-=(const BandMatrix &a) {
+  merge(a, -1.);
+  return *this;
+}
+
+BandMatrix &BandMatrix::operator*=(const double &number) {
+  vectorScale(this->values.data(), number, this->values.size());
+  return *this;
+}
+
+BandMatrix BandMatrix::operator+(const BandMatrix &a) const {
+  BandMatrix new_mat(*this);
+  new_mat += a;
+
+  return new_mat;
+}
+
+BandMatrix BandMatrix::operator-(const BandMatrix &a) const {
+  BandMatrix new_mat(*this);
+  new_mat -= a;
+
+  return new_mat;
+}
+
+BandMatrix BandMatrix::operator*(const double &number) const {
+  BandMatrix new_mat(*this);
+  new_mat *= number;
+
+  return new_mat;
+}
+
+BandMatrix BandMatrix::operator-() const { return *this * -1.; }
+
+void BandMatrix::multiply(const double *x, double *y) const {
+  parallelForRanges(this->size, this->values.size(), GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      size_t from = first_col(i);
+      y[i] = vectorDot(this->values.data() + i * width() + from + this->bandwidth - i, x + from,
+                       last_col(i) - from + 1);
+    }
+  });
+}
+
+std::vector<double> BandMatrix::operator*(const std::vector<double> &x) const {
+  if (x.size() != this->size)
+    throw SizeMismatchException();
+
+  std::vector<double> y(this->size);
+  multiply(x.data(), y.data());
+  return y;
+}
+
+Matrix BandMatrix::operator*(const Matrix &b) const {
+  if (b.getNumRows() != this->size)
+    throw SizeMismatchException();
+
+  size_t n = b.getNumCols();
+  Matrix result = zero_matrix(this->size, n);
+  parallelForRanges(this->size, this->values.size() * n, GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      double *out = result[i];
+      for (size_t j = first_col(i); j <= last_col(i); ++j)
+        vectorAxpy(out, this->values[i * width() + j + this->bandwidth - i], b[j], n);
+    }
+  });
+  return result;
+}
+
+// Row i of A B is the sum of A(i, k) times the band of row k of B, which lies inside the wider band
+// of the product, so every term is one axpy on stored values.
+BandMatrix BandMatrix::operator*(const BandMatrix &b) const {
+  if (b.size != this->size)
+    throw SizeMismatchException();
+
+  BandMatrix result(this->size, this->bandwidth + b.bandwidth);
+  parallelForRanges(this->size, this->values.size() * b.width(), GEMV_PARALLEL_CUTOFF, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+      for (size_t k = first_col(i); k <= last_col(i); ++k) {
+        size_t from = b.first_col(k);
+        vectorAxpy(result.values.data() + i * result.width() + from + result.bandwidth - i,
+                   this->values[i * width() + k + this->bandwidth - i],
+                   b.values.data() + k * b.width() + from + b.bandwidth - k, b.last_col(k) - from + 1);
+      }
+  });
+  return result;
+}
+
+double BandMatrix::det() const {
+  // Row i keeps columns i - bandwidth .. i + 2 bandwidth: the lower band, the diagonal and the upper
+  // band widened by the fill-in of row swaps, which only exchange a row with one of the next bandwidth.
+  const size_t k = this->bandwidth, lu_width = 3 * k + 1;
+  std::vector<double> lu(this->size * lu_width, 0.);
+  auto at = [&](size_t row, size_t col) { return lu.data() + row * lu_width + col + k - row; };
+
+  for (size_t i = 0; i < this->size; ++i)
+    std::copy(this->values.begin() + i * width() + first_col(i) + k - i,
+              this->values.begin() + i * width() + last_col(i) + k - i + 1, at(i, first_col(i)));
+
+  double det = 1.;
+  for (size_t s = 0; s < this->size; ++s) {
+    size_t last_row = std::min(this->size - 1, s + k);
+    size_t last = std::min(this->size - 1, s + 2 * k);
+    size_t pivot = s;
+    for (size_t i = s + 1; i <= last_row; ++i)
+      if (std::fabs(*at(i, s)) > std::fabs(*at(pivot, s)))
+        pivot = i;
+    if (*at(pivot, s) == 0.)
+      return 0.;
+    if (pivot != s) {
+      std::swap_ranges(at(s, s), at(s, last) + 1, at(pivot, s));
+      det = -det;
+    }
+
+    det *= *at(s, s);
+    for (size_t i = s + 1; i <= last_row; ++i)
+      vectorAxpy(at(i, s + 1), -*at(i, s) / *at(s, s), at(s, s + 1), last - s);
+  }
+  return det;
+}
+
+double BandMatrix::trace() const {
+  double trace = 0.;
+
+  for (size_t i = 0; i < this->size; ++i)
+    trace += this->values[i * width() + this->bandwidth];
+  return trace;
+}
+
+size_t BandMatrix::getBandwidth() const { return this->bandwidth; }
+
+size_t BandMatrix::getNumRows() const { return this->size; }
+
+size_t BandMatrix::getNumCols() const { return this->size; }
+
+SymmetricMatrix task::operator*(const double &number, const SymmetricMatrix &a) { return a * number; }
+
+TriangularMatrix task::operator*(const double &number, const TriangularMatrix &a) { return a * number; }
+
+DiagonalMatrix task::operator*(const double &number, const DiagonalMatrix &a) { return a * number; }
+
+BandMatrix task::operator*(const double &number, const BandMatrix &a) { return a * number; }
+
+// A B = (B^T A^T)^T, with B^T as cheap as B for every structure, so the structured kernels do the work.
+Matrix task::operator*(const Matrix &a, const SymmetricMatrix &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+
+  return (b * a.transposed()).transposed();
+}
+
+Matrix task::operator*(const Matrix &a, const TriangularMatrix &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+
+  return (b.transposed() * a.transposed()).transposed();
+}
+
+Matrix task::operator*(const Matrix &a, const DiagonalMatrix &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+
+  Matrix result(a);
+  const double *d = b.getDiagonal().data();
+  size_t n = result.getNumCols();
+  for (size_t i = 0; i < result.getNumRows(); ++i) {
+    double *row = result[i];
+#pragma GCC ivdep
+    for (size_t j = 0; j < n; ++j)
+      row[j] *= d[j];
+  }
+  return result;
+}
+
+Matrix task::operator*(const Matrix &a, const BandMatrix &b) {
+  if (a.getNumCols() != b.getNumRows())
+    throw SizeMismatchException();
+
+  return (b.transposed() * a.transposed()).transposed();
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+// Rows of a packed matrix unpacked at a time for one gemm call in products with a Matrix.
+const size_t STRUCTURED_BLOCK = 128;
+
+// Square matrices whose structure fixes most elements at zero, or mirrors them, store only the rest.
+// Their kernels touch only the stored elements, and an explicit constructor from Matrix and toDense()
+// convert both ways. get() reads structural zeros as 0; set() throws OutOfBoundsException for them.
+// Operands of different sizes throw SizeMismatchException.
+
+// Symmetric matrix holding its lower triangle packed row by row: element (i, j), j <= i, at
+// i (i + 1) / 2 + j, so n (n + 1) / 2 values instead of n^2.
+class SymmetricMatrix {
+ public:
+  explicit SymmetricMatrix(size_t size);
+  // Reads the lower triangle; the upper one is taken to mirror it.
+  explicit SymmetricMatrix(const Matrix &dense);
+
+  Matrix toDense() const;
+  SymmetricMatrix transposed() const;
+
+  double get(size_t row, size_t col) const;
+  // Sets both (row, col) and (col, row).
+  void set(size_t row, size_t col, const double &value);
+
+  SymmetricMatrix &operator+=(const SymmetricMatrix &a);
+  SymmetricMatrix &operator-=(const SymmetricMatrix &a);
+  SymmetricMatrix &operator*=(const double &number);
+
+  SymmetricMatrix operator+(const SymmetricMatrix &a) const;
+  SymmetricMatrix operator-(const SymmetricMatrix &a) const;
+  SymmetricMatrix operator*(const double &number) const;
+  SymmetricMatrix operator-() const;
+
+  // y = A x, reading every stored value once for both of its positions.
+  void multiply(const double *x, double *y) const;
+  std::vector<double> operator*(const std::vector<double> &x) const;
+  Matrix operator*(const Matrix &b) const;
+
+  // Cholesky on a packed copy, half the work of LU, while the matrix is positive definite as
+  // covariance matrices are; any other matrix goes through LDL^T with Bunch-Kaufman pivoting, still
+  // packed. Neither builds the dense matrix.
+  double det() const;
+  double trace() const;
+
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  size_t size;
+  std::vector<double> values;
+};
+
+// Lower or upper triangular matrix, packed like SymmetricMatrix: the lower triangle row by row and
+// the upper one column by column, so the transpose of either is the other one over the same values.
+class TriangularMatrix {
+ public:
+  enum class Triangle { Lower, Upper };
+
+  explicit TriangularMatrix(size_t size, Triangle triangle = Triangle::Lower);
+  // Reads the given triangle, diagonal included, and ignores the other one.
+  explicit TriangularMatrix(const Matrix &dense, Triangle triangle = Triangle::Lower);
+
+  Matrix toDense() const;
+  // Relabels Lower as Upper and vice versa without touching the values.
+  TriangularMatrix transposed() const;
+
+  double get(size_t row, size_t col) const;
+  void set(size_t row, size_t col, const double &value);
+
+  // Operands of + and - and both factors of a triangular product must share the triangle,
+  // otherwise SizeMismatchException is thrown; use toDense() to mix them.
+  TriangularMatrix &operator+=(const TriangularMatrix &a);
+  TriangularMatrix &operator-=(const TriangularMatrix &a);
+  TriangularMatrix &operator*=(const double &number);
+
+  TriangularMatrix operator+(const TriangularMatrix &a) const;
+  TriangularMatrix operator-(const TriangularMatrix &a) const;
+  TriangularMatrix operator*(const double &number) const;
+  TriangularMatrix operator-() const;
+
+  void multiply(const double *x, double *y) const;
+  std::vector<double> operator*(const std::vector<double> &x) const;
+  Matrix operator*(const Matrix &b) const;
+  TriangularMatrix operator*(const TriangularMatrix &b) const;
+
+  // The product of the diagonal.
+  double det() const;
+  double trace() const;
+
+  Triangle getTriangle() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  size_t size;
+  Triangle triangle;
+  std::vector<double> values;
+
+  bool stored(size_t row, size_t col) const;
+};
+
+class DiagonalMatrix {
+ public:
+  explicit DiagonalMatrix(size_t size);
+  explicit DiagonalMatrix(const std::vector<double> &diagonal);
+  // Reads the diagonal and ignores everything else.
+  explicit DiagonalMatrix(const Matrix &dense);
+
+  Matrix toDense() const;
+  DiagonalMatrix transposed() const;
+
+  double get(size_t row, size_t col) const;
+  void set(size_t row, size_t col, const double &value);
+
+  DiagonalMatrix &operator+=(const DiagonalMatrix &a);
+  DiagonalMatrix &operator-=(const DiagonalMatrix &a);
+  DiagonalMatrix &operator*=(const double &number);
+
+  DiagonalMatrix operator+(const DiagonalMatrix &a) const;
+  DiagonalMatrix operator-(const DiagonalMatrix &a) const;
+  DiagonalMatrix operator*(const double &number) const;
+  DiagonalMatrix operator-() const;
+
+  void multiply(const double *x, double *y) const;
+  std::vector<double> operator*(const std::vector<double> &x) const;
+  // Scales the rows of b.
+  Matrix operator*(const Matrix &b) const;
+  DiagonalMatrix operator*(const DiagonalMatrix &b) const;
+
+  double det() const;
+  double trace() const;
+
+  const std::vector<double> &getDiagonal() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  std::vector<double> values;
+};
+
+// Band matrix of elements (i, j) with |i - j| <= bandwidth, stored row by row in rows of
+// 2 bandwidth + 1 values: (i, j) at i (2 bandwidth + 1) + j - i + bandwidth. The cells of the first
+// and last rows that fall outside the matrix stay zero. Memory is O(size * bandwidth).
+class BandMatrix {
+ public:
+  // The bandwidth is capped at size - 1.
+  BandMatrix(size_t size, size_t bandwidth);
+  // Reads the band and ignores everything outside it.
+  BandMatrix(const Matrix &dense, size_t bandwidth);
+
+  Matrix toDense() const;
+  BandMatrix transposed() const;
+
+  double get(size_t row, size_t col) const;
+  void set(size_t row, size_t col, const double &value);
+
+  // The sum keeps the larger bandwidth.
+  BandMatrix &operator+=(const BandMatrix &a);
+  BandMatrix &operator-=(const BandMatrix &a);
+  BandMatrix &operator*=(const double &number);
+
+  BandMatrix operator+(const BandMatrix &a) const;
+  BandMatrix operator-(const BandMatrix &a) const;
+  BandMatrix operator*(const double &number) const;
+  BandMatrix operator-() const;
+
+  void multiply(const double *x, double *y) const;
+  std::vector<double> operator*(const std::vector<double> &x) const;
+  Matrix operator*(const Matrix &b) const;
+  // The product has the sum of the bandwidths.
+  BandMatrix operator*(const BandMatrix &b) const;
+
+  // LU with partial pivoting inside the band: row swaps widen the band of U to 2 bandwidth above the
+  // diagonal, so the cost is O(size * bandwidth^2).
+  double det() const;
+  double trace() const;
+
+  size_t getBandwidth() const;
+  size_t getNumRows() const;
+  size_t getNumCols() const;
+
+ private:
+  size_t size;
+  size_t bandwidth;
+  std::vector<double> values;
+
+  size_t width() const;
+  // First and last column of the band in row.
+  size_t first_col(size_t row) const;
+  size_t last_col(size_t row) const;
+  BandMatrix widened(size_t new_bandwidth) const;
+  void merge(const BandMatrix &a, double sign);
+};
+
+SymmetricMatrix operator*(const double &number, const SymmetricMatrix &a);
+TriangularMatrix operator*(const double &number, const TriangularMatrix &a);
+DiagonalMatrix operator*(const double &number, const DiagonalMatrix &a);
+BandMatrix operator*(const double &number, const BandMatrix &a);
+
+Matrix operator*(const Matrix &a, const SymmetricMatrix &b);
+Matrix operator*(const Matrix &a, const TriangularMatrix &b);
+// Scales the columns of a.
+Matrix operator*(const Matrix &a, const DiagonalMatrix &b);
+Matrix operator*(const Matrix &a, const BandMatrix &b);
+
+}  // namespace task
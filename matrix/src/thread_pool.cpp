@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <memory>
+#include "thread_pool.h"
+
+using namespace task;
+
+namespace {
+
+thread_local bool inside_pool_task = false;
+
+std::mutex default_pool_mutex;
+std::unique_ptr<ThreadPool> default_pool;
+size_t default_pool_threads = 0;
+
+size_t resolve_num_threads(size_t n_threads) {
+  if (n_threads != 0)
+    return n_threads;
+  else
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t n_threads)
+    : job(nullptr), job_size(0), next_task(0), active_workers(0), generation(0), stop(false) {
+  for (size_t i = 1; i < n_threads; ++i)
+    this->workers.emplace_back([this] { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->stop = true;
+  }
+  this->wake.notify_all();
+  for (auto &worker : this->workers)
+    worker.join();
+}
+
+size_t ThreadPool::getNumThreads() const { return this->workers.size() + 1; }
+
+void ThreadPool::parallelFor(size_t n_tasks, const std::function<void(size_t)> &task) {
+  if (this->workers.empty() or n_tasks <= 1 or inside_pool_task) {
+    for (size_t i = 0; i < n_tasks; ++i)
+      task(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> call_lock(this->call_mutex);
+  {
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    this->job = &task;
+    this->job_size = n_tasks;
+    this->next_task = 0;
+    this->active_workers = this->workers.size();
+    this->error = nullptr;
+    ++this->generation;
+  }
+  this->wake.notify_all();
+
+  inside_pool_task = true;
+  run_tasks();
+  inside_pool_task = false;
+
+  std::exception_ptr task_error;
+  {
+    std::unique_lock<std::mutex> lock(this->state_mutex);
+    this->done.wait(lock, [this] { return this->active_workers == 0; });
+    this->job = nullptr;
+    task_error = this->error;
+  }
+  if (task_error)
+    std::rethrow_exception(task_error);
+}
+
+void ThreadPool::worker_loop() {
+  size_t seen_generation = 0;
+  inside_pool_task = true;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(this->state_mutex);
+      this->wake.wait(lock, [&] { return this->stop or this->generation != seen_generation; });
+      if (this->stop)
+        return;
+      seen_generation = this->generation;
+    }
+
+    run_tasks();
+
+    std::lock_guard<std::mutex> lock(this->state_mutex);
+    if (--this->active_workers == 0)
+      this->done.notify_one();
+  }
+}
+
+void ThreadPool::run_tasks() {
+  for (size_t i = this->next_task++; i < this->job_size; i = this->next_task++) {
+    try {
+      (*this->job)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(this->state_mutex);
+      if (!this->error)
+        this->error = std::current_exception();
+    }
+  }
+}
+
+void task::setNumThreads(size_t n_threads) {
+  std::lock_guard<std::mutex> lock(default_pool_mutex);
+  default_pool_threads = n_threads;
+  default_pool.reset();
+}
+
+size_t task::getNumThreads() { return defaultThreadPool().getNumThreads(); }
+
+ThreadPool &task::defaultThreadPool() {
+  std::lock_guard<std::mutex> lock(default_pool_mutex);
+  if (!default_pool)
+    default_pool.reset(new ThreadPool(resolve_num_threads(default_pool_threads)));
+  return *default_pool;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace task {
+
+class ThreadPool {
+ public:
+  // The calling thread takes part in every parallelFor, so n_threads - 1 workers are spawned.
+  explicit ThreadPool(size_t n_threads);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool();
+
+  size_t getNumThreads() const;
+
+  // Runs task(i) for every i in [0, n_tasks) and returns when all of them are finished.
+  // Calls made from inside a task run inline on the current thread.
+  void parallelFor(size_t n_tasks, const std::function<void(size_t)> &task);
+
+ private:
+  std::vector<std::thread> workers;
+  std::mutex call_mutex;
+  std::mutex state_mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  const std::function<void(size_t)> *job;
+  size_t job_size;
+  std::atomic<size_t> next_task;
+  size_t active_workers;
+  size_t generation;
+  bool stop;
+  std::exception_ptr error;
+
+  void worker_loop();
+  void run_tasks();
+};
+
+// Pool shared by the parallel kernels. Zero threads means one per hardware thread;
+// changing the count must not race with running products.
+void setNumThreads(size_t n_threads);
+size_t getNumThreads();
+ThreadPool &defaultThreadPool();
+
+// Runs part(begin, end) over [0, count) split into a few ranges per thread of defaultThreadPool()
+// once the kernel touches at least cutoff elements (volume), and in one call otherwise. Every
+// part must write only what its own range owns.
+template<class F>
+void parallelForRanges(size_t count, size_t volume, size_t cutoff, F &&part) {
+  ThreadPool &pool = defaultThreadPool();
+  if (volume < cutoff or pool.getNumThreads() == 1 or count < 2) {
+    part(0, count);
+    return;
+  }
+
+  size_t n_parts = std::min(count, 4 * pool.getNumThreads());
+  size_t chunk = (count + n_parts - 1) / n_parts;
+  pool.parallelFor((count + chunk - 1) / chunk, [&](size_t index) {
+    part(index * chunk, std::min(count, (index + 1) * chunk));
+  });
+}
+
+}  // namespace task
@@ -0,0 +1,111 @@
+// Built by run.sh with -DTASK_MATRIX_STATS, which test.cpp is not.
+#include <iostream>
+#include <string>
+#include "src/matrix.h"
+#include "src/matrix_stats.h"
+
+
+using task::Matrix;
+using task::MatrixOp;
+
+
+void FailWithMsg(const std::string& msg, int line) {
+    std::cerr << "Test failed!\n";
+    std::cerr << "[Line " << line << "] "  << msg << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+#define ASSERT_TRUE_MSG(cond, msg) \
+    if (!(cond)) {FailWithMsg(msg, __LINE__);};
+
+
+int main() {
+
+    {
+        auto stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats.enabled, "getMatrixStats() with TASK_MATRIX_STATS")
+
+        // Something for resetMatrixStats() to clear.
+        Matrix mat1(20, 30);
+        mat1.transpose();
+
+        task::resetMatrixStats();
+        stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats.allocations == 0 && stats.bytes_allocated == 0, "resetMatrixStats()")
+        for (const auto& op : stats.ops)
+            ASSERT_TRUE_MSG(op.calls == 0 && op.flops == 0 && op.bytes_allocated == 0 && op.nanoseconds == 0,
+                            "resetMatrixStats()")
+
+        std::string json = "{\"enabled\": true, \"allocations\": 0, \"bytes_allocated\": 0, \"ops\": {";
+        for (const char* name : {"copy", "detach", "multiply", "multiply_assign", "pow", "det", "transpose", "resize"})
+            json += std::string(json.back() == '{' ? "" : ", ") + '"' + name
+                    + "\": {\"calls\": 0, \"flops\": 0, \"bytes_allocated\": 0, \"nanoseconds\": 0}";
+        json += "}}";
+        ASSERT_TRUE_MSG(stats.toJson() == json, "MatrixStats::toJson()")
+    }
+
+    {
+        Matrix mat1(20, 30), mat2(30, 40);
+        const uint64_t FLOPS = 2 * 20 * 30 * 40;
+
+        task::resetMatrixStats();
+        auto product = mat1 * mat2;
+        auto stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats[MatrixOp::MULTIPLY].calls == 1 && stats[MatrixOp::MULTIPLY].flops == FLOPS,
+                        "Matrix operator * counters")
+        ASSERT_TRUE_MSG(stats[MatrixOp::MULTIPLY].bytes_allocated >= 20 * 40 * sizeof(double),
+                        "Matrix operator * is charged for its result")
+        ASSERT_TRUE_MSG(stats.allocations >= 1 && stats.bytes_allocated >= stats[MatrixOp::MULTIPLY].bytes_allocated,
+                        "Matrix operator * allocations")
+
+        task::resetMatrixStats();
+        mat1 *= mat2;
+        stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats[MatrixOp::MULTIPLY_ASSIGN].calls == 1 && stats[MatrixOp::MULTIPLY_ASSIGN].flops == FLOPS,
+                        "Matrix operator *= counters")
+        ASSERT_TRUE_MSG(stats[MatrixOp::MULTIPLY].calls == 1 && stats[MatrixOp::MULTIPLY].flops == FLOPS,
+                        "Matrix operator *= counts its product as a multiply")
+        ASSERT_TRUE_MSG(stats[MatrixOp::MULTIPLY_ASSIGN].bytes_allocated >= stats[MatrixOp::MULTIPLY].bytes_allocated
+                        && stats[MatrixOp::MULTIPLY].bytes_allocated > 0, "Matrix operator *= bytes are inclusive")
+        ASSERT_TRUE_MSG(mat1 == product, "Matrix operator *= with counters")
+    }
+
+    {
+        Matrix square(10, 10);
+        for (size_t i = 0; i < 10; ++i)
+            square[i][(i + 3) % 10] = 2.;
+
+        task::resetMatrixStats();
+        square.det();
+        auto stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats[MatrixOp::DET].calls == 1 && stats[MatrixOp::DET].flops == 2 * 10 * 10 * 10 / 3,
+                        "Matrix::det() counters")
+
+        Matrix wide(20, 30);
+        task::resetMatrixStats();
+        wide.transpose();
+        auto transposed = wide.transposed();
+        stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats[MatrixOp::TRANSPOSE].calls == 2 && stats[MatrixOp::TRANSPOSE].flops == 0,
+                        "Matrix::transpose() / transposed() counters")
+        ASSERT_TRUE_MSG(stats[MatrixOp::TRANSPOSE].bytes_allocated >= 20 * 30 * sizeof(double),
+                        "Matrix::transposed() is charged for its result")
+
+        task::resetMatrixStats();
+        wide.resize(5, 5);
+        wide.resize(50, 50);
+        stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats[MatrixOp::RESIZE].calls == 2 && stats[MatrixOp::RESIZE].flops == 0,
+                        "Matrix::resize() counters")
+        ASSERT_TRUE_MSG(stats[MatrixOp::RESIZE].bytes_allocated >= 50 * 50 * sizeof(double),
+                        "Matrix::resize() is charged for its new buffer")
+
+        task::resetMatrixStats();
+        stats = task::getMatrixStats();
+        ASSERT_TRUE_MSG(stats.allocations == 0 && stats[MatrixOp::RESIZE].calls == 0
+                        && stats[MatrixOp::TRANSPOSE].calls == 0 && stats[MatrixOp::DET].calls == 0,
+                        "resetMatrixStats() after counted operations")
+    }
+
+    return 0;
+}
@@ -4,7 +4,25 @@
 #include <algorithm>
 #include <sstream>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
 #include "src/matrix.h"
+#include "src/buffer_pool.h"
+#include "src/lu.h"
+#include "src/cholesky.h"
+#include "src/qr.h"
+#include "src/matrix_batch.h"
+#include "src/matrix_chain.h"
+#include "src/fixed_matrix.h"
+#include "src/matrix_io.h"
+#include "src/sparse_matrix.h"
+#include "src/structured_matrix.h"
+#include "src/simd.h"
+#include "src/strassen.h"
+#include "src/thread_pool.h"
 
 
 using task::Matrix;
@@ -44,6 +62,49 @@ Matrix RandomMatrix(size_t rows, size_t cols) {
 }
 
 
+// Whether every element of the vector is within EPS of the single column of expected.
+bool IsColumn(const std::vector<double>& values, const Matrix& expected) {
+    if (values.size() != expected.getNumRows()) {
+        return false;
+    }
+    for (size_t row = 0; row < values.size(); ++row) {
+        if (fabs(values[row] - expected.get(row, 0)) > task::EPS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether resized holds the elements of orig it overlaps and zeros elsewhere.
+bool IsResized(const Matrix& resized, const Matrix& orig) {
+    for (size_t row = 0; row < resized.getNumRows(); ++row) {
+        for (size_t col = 0; col < resized.getNumCols(); ++col) {
+            bool kept = row < orig.getNumRows() && col < orig.getNumCols();
+            if (resized.get(row, col) != (kept ? orig.get(row, col) : 0.)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr task::FixedMatrix<2, 2> FixedTwoByTwo(double a, double b, double c, double d) {
+    task::FixedMatrix<2, 2> result;
+    result[0][0] = a;
+    result[0][1] = b;
+    result[1][0] = c;
+    result[1][1] = d;
+    return result;
+}
+
+// Input buffer that cannot seek, like a pipe.
+struct UnseekableBuffer : std::streambuf {
+    explicit UnseekableBuffer(std::string& data) {
+        setg(&data[0], &data[0], &data[0] + data.size());
+    }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -62,7 +123,7 @@ void FailWithMsg(const std::string& msg, int line) {
     if (!ok) FailWithMsg(msg, __LINE__);}
 
 
-#define REPEAT(count) for (size_t _iter = 0; _iter < (count); ++_iter)
+#define REPEAT(count) for (size_t _iter = 0; _iter < static_cast<size_t>(count); ++_iter)
 
 
 const double EPS = 1e-6;
@@ -208,6 +269,909 @@ int main(int argc, char** argv) {
     }
 
 
+    {
+        // Shapes that leave remainders in every GEMM_MR / GEMM_NR / GEMM_KC / GEMM_MC block of the packed path.
+        const size_t SHAPES[][3] = {{97, 259, 301}, {257, 255, 513}};
+        for (const auto& shape : SHAPES) {
+            size_t m = shape[0], k = shape[1], n = shape[2];
+            auto mat1 = RandomMatrix(m, k);
+            auto mat2 = RandomMatrix(k, n);
+            Matrix expected(m, n);
+            task::BasicMatrix<int> ints1(m, k), ints2(k, n), expected_ints(m, n);
+            for (size_t row = 0; row < m; ++row)
+                for (size_t col = 0; col < k; ++col)
+                    ints1[row][col] = static_cast<int>(RandomUInt(20)) - 10;
+            for (size_t row = 0; row < k; ++row)
+                for (size_t col = 0; col < n; ++col)
+                    ints2[row][col] = static_cast<int>(RandomUInt(20)) - 10;
+            for (size_t row = 0; row < m; ++row)
+                for (size_t col = 0; col < n; ++col) {
+                    double sum = 0.;
+                    int int_sum = 0;
+                    for (size_t i = 0; i < k; ++i) {
+                        sum += mat1[row][i] * mat2[i][col];
+                        int_sum += ints1[row][i] * ints2[i][col];
+                    }
+                    expected[row][col] = sum;
+                    expected_ints[row][col] = int_sum;
+                }
+            ASSERT_TRUE_MSG(mat1 * mat2 == expected, "Matrix operator * on the packed path")
+            ASSERT_TRUE_MSG(mat1.transposed().transposedView() * mat2 == expected,
+                            "Matrix operator * of a transposed view on the packed path")
+            ASSERT_TRUE_MSG(ints1 * ints2 == expected_ints, "int matrix operator * on the packed path")
+        }
+    }
+
+
+    {
+        // Large enough to be split into GEMM_MC x GEMM_TILE_N tiles over the pool; every element of
+        // the product must still come out bit for bit the same whatever the thread count.
+        size_t threads = task::getNumThreads();
+        auto mat1 = RandomMatrix(700, 650);
+        auto mat2 = RandomMatrix(650, 900);
+        task::setNumThreads(1);
+        auto expected = mat1 * mat2;
+        for (size_t n_threads : {3, 8}) {
+            task::setNumThreads(n_threads);
+            auto product = mat1 * mat2;
+            for (size_t row = 0; row < 700; ++row)
+                ASSERT_TRUE_MSG(std::memcmp(product[row], expected[row], 900 * sizeof(double)) == 0,
+                                "Matrix operator * gives the same bits for every thread count")
+        }
+        task::setNumThreads(threads);
+
+        // An exception thrown by a task reaches the caller, and the pool keeps working afterwards.
+        task::ThreadPool pool(4);
+        ASSERT_EXCEPTION_MSG(pool.parallelFor(100, [](size_t i) {
+            if (i == 37)
+                throw std::runtime_error("task failed");
+        }), std::runtime_error, "ThreadPool::parallelFor() rethrows the exception of a task")
+        std::atomic<size_t> finished{0};
+        pool.parallelFor(100, [&](size_t) { ++finished; });
+        ASSERT_TRUE_MSG(finished == 100, "ThreadPool::parallelFor() after a task threw")
+    }
+
+
+    {
+        // With the crossover at 32 these shapes recurse one to three levels and peel odd dimensions.
+        bool enabled = task::isStrassenEnabled();
+        size_t crossover = task::getStrassenCrossover();
+        const size_t SHAPES[][3] = {{65, 65, 65}, {97, 131, 75}, {200, 67, 151}, {129, 257, 130}};
+        for (const auto& shape : SHAPES) {
+            auto mat1 = RandomMatrix(shape[0], shape[1]);
+            auto mat2 = RandomMatrix(shape[1], shape[2]);
+            task::setStrassenEnabled(false);
+            auto expected = mat1 * mat2;
+            task::setStrassenEnabled(true);
+            task::setStrassenCrossover(32);
+            auto product = mat1 * mat2;
+            task::setStrassenEnabled(enabled);
+            task::setStrassenCrossover(crossover);
+
+            // The normwise bound of strassen.h, c (n0^2 + 5 n0) 18^l u ||A|| ||B||, with c = 1.
+            size_t m = shape[0], k = shape[1], n = shape[2], levels = 0;
+            for (; m > 32 && k > 32 && n > 32; m /= 2, k /= 2, n /= 2)
+                ++levels;
+            size_t n0 = std::max({m, k, n});
+            double norm1 = 0., norm2 = 0., error = 0.;
+            for (size_t row = 0; row < mat1.getNumRows(); ++row)
+                for (size_t col = 0; col < mat1.getNumCols(); ++col)
+                    norm1 += mat1[row][col] * mat1[row][col];
+            for (size_t row = 0; row < mat2.getNumRows(); ++row)
+                for (size_t col = 0; col < mat2.getNumCols(); ++col)
+                    norm2 += mat2[row][col] * mat2[row][col];
+            for (size_t row = 0; row < shape[0]; ++row)
+                for (size_t col = 0; col < shape[2]; ++col)
+                    error += (product[row][col] - expected[row][col]) * (product[row][col] - expected[row][col]);
+            double bound = (n0 * n0 + 5. * n0) * std::pow(18., levels) * std::ldexp(1., -53)
+                           * std::sqrt(norm1 * norm2);
+            ASSERT_TRUE_MSG(levels > 0 && std::sqrt(error) <= bound, "Strassen-Winograd product against gemm")
+        }
+        ASSERT_TRUE_MSG(task::isStrassenEnabled() == enabled && task::getStrassenCrossover() == crossover,
+                        "setStrassenEnabled() / setStrassenCrossover()")
+    }
+
+
+    {
+        // Non-square shapes above TRANSPOSE_BLOCK go through the cycle-following path; 150 x 97 is
+        // spread back to a padded stride afterwards, 3 x 200 and 64 x 65 stay dense.
+        const size_t SHAPES[][2] = {{3, 200}, {150, 97}, {64, 65}};
+        for (const auto& shape : SHAPES) {
+            size_t rows = shape[0], cols = shape[1];
+            auto orig = RandomMatrix(rows, cols);
+            auto snapshot = Matrix(orig.view());
+            auto mat1 = orig;
+            mat1.transpose();
+            ASSERT_TRUE_MSG(mat1.getNumRows() == cols && mat1.getNumCols() == rows,
+                            "transpose() of a rectangular matrix")
+            for (size_t row = 0; row < cols; ++row)
+                for (size_t col = 0; col < rows; ++col)
+                    ASSERT_TRUE_MSG(mat1[row][col] == orig[col][row], "transpose() of a rectangular matrix")
+            ASSERT_TRUE_MSG(orig == snapshot, "transpose() leaves a copy alone")
+
+            const double* data = mat1.view().data();
+            size_t capacity = mat1.capacity();
+            mat1.transpose();
+            ASSERT_TRUE_MSG(mat1.getNumRows() == rows && mat1.getNumCols() == cols, "transpose() twice")
+            for (size_t row = 0; row < rows; ++row)
+                for (size_t col = 0; col < cols; ++col)
+                    ASSERT_TRUE_MSG(mat1[row][col] == orig[row][col], "transpose() twice")
+            ASSERT_TRUE_MSG(mat1.view().data() == data && mat1.capacity() == capacity,
+                            "transpose() of an unshared matrix stays in its buffer")
+
+            auto moved = Matrix(orig).transposed();
+            ASSERT_TRUE_MSG(moved.getNumRows() == cols && moved == orig.transposed(), "transposed() of a temporary")
+        }
+    }
+
+
+    {
+        // Products with a temporary matrix own their result; those of lvalues stay lazy until assigned.
+        auto mat1 = RandomMatrix(4, 5), mat2 = RandomMatrix(4, 5);
+        auto scaled = 2. * Matrix(mat1);
+        auto scaled_right = Matrix(mat1) * 2.;
+        auto sum = Matrix(mat1) + mat2;
+        static_assert(std::is_same<decltype(scaled), Matrix>::value, "double * Matrix&& is a Matrix");
+        static_assert(std::is_same<decltype(scaled_right), Matrix>::value, "Matrix&& * double is a Matrix");
+        static_assert(std::is_same<decltype(sum), Matrix>::value, "Matrix&& + Matrix is a Matrix");
+        for (size_t row = 0; row < 4; ++row)
+            for (size_t col = 0; col < 5; ++col) {
+                ASSERT_TRUE_MSG(scaled[row][col] == 2. * mat1[row][col], "double * Matrix&&")
+                ASSERT_TRUE_MSG(scaled_right[row][col] == mat1[row][col] * 2., "Matrix&& * double")
+                ASSERT_TRUE_MSG(sum[row][col] == mat1[row][col] + mat2[row][col], "Matrix&& + Matrix")
+            }
+
+        auto lazy = 2. * mat1 + mat2;
+        static_assert(!std::is_same<decltype(lazy), Matrix>::value, "double * Matrix& is an expression");
+        Matrix evaluated = lazy;
+        ASSERT_TRUE_MSG(evaluated == lazy.eval() && evaluated == scaled + mat2, "Evaluating an expression")
+        mat1[0][0] += 1.;
+        ASSERT_TRUE_MSG(fabs(lazy.eval()[0][0] - evaluated[0][0] - 2.) < EPS,
+                        "An expression reads its leaves when evaluated")
+    }
+
+
+    for (size_t size : {3, 50})
+    {
+        // Views of the target read other elements than the one being written.
+        auto mat1 = RandomMatrix(size, size);
+        auto orig = mat1;
+        Matrix expected(size, size);
+
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = 0; j < size; ++j)
+                expected[i][j] = orig[i][j] + orig[j][i];
+        mat1 += mat1.transposedView();
+        ASSERT_TRUE_MSG(mat1 == expected, "Operator += with an aliasing view")
+
+        mat1 = orig;
+        mat1 -= mat1.transposedView();
+        ASSERT_TRUE_MSG(mat1 == orig - orig.transposed(), "Operator -= with an aliasing view")
+
+        mat1 = orig;
+        mat1 = mat1.transposedView();
+        ASSERT_TRUE_MSG(mat1 == orig.transposed(), "Operator = with an aliasing view")
+
+        mat1 = orig;
+        mat1 = mat1.transposedView() + mat1;
+        ASSERT_TRUE_MSG(mat1 == expected, "Operator = with an aliasing expression")
+
+        mat1 = orig;
+        mat1 = mat1.block(1, 1, size - 1, size - 1);
+        ASSERT_TRUE_MSG(mat1 == orig.block(1, 1, size - 1, size - 1), "Operator = with a block view")
+    }
+
+
+    for (size_t size : {7, 400})
+    {
+        // At 400 x 400 the CSR products go over the thread pool.
+        auto dense = RandomMatrix(size, size + 3);
+        for (size_t row = 0; row < dense.getNumRows(); ++row)
+            for (size_t col = 0; col < dense.getNumCols(); ++col)
+                if (RandomUInt(2) != 0)
+                    dense[row][col] = 0.;
+        auto other = RandomMatrix(size + 3, 5);
+        std::vector<double> x(size + 3);
+        for (double &value : x)
+            value = RandomDouble();
+
+        task::SparseMatrix csr(dense), csc(dense, task::SparseMatrix::Format::CSC);
+        ASSERT_TRUE_MSG(csr.toDense() == dense, "SparseMatrix CSR round-trip")
+        ASSERT_TRUE_MSG(csc.toDense() == dense, "SparseMatrix CSC round-trip")
+        ASSERT_TRUE_MSG(csr.toFormat(task::SparseMatrix::Format::CSC).toDense() == dense, "SparseMatrix::toFormat()")
+        ASSERT_TRUE_MSG(csr.getNumNonZeros() == csc.getNumNonZeros(), "SparseMatrix::getNumNonZeros()")
+        ASSERT_TRUE_MSG(csr.transposed().toDense() == dense.transposed(), "SparseMatrix::transposed()")
+        if (size == 400)
+            ASSERT_TRUE_MSG(csr.getNumNonZeros() >= task::SPARSE_PARALLEL_CUTOFF, "SparseMatrix parallel path")
+
+        for (const auto &sparse : {csr, csc}) {
+            auto y = sparse * x;
+            ASSERT_TRUE_MSG(y.size() == size, "SparseMatrix SpMV")
+            for (size_t row = 0; row < size; ++row) {
+                double expected = 0.;
+                for (size_t col = 0; col < x.size(); ++col)
+                    expected += dense[row][col] * x[col];
+                ASSERT_TRUE_MSG(fabs(y[row] - expected) < EPS, "SparseMatrix SpMV")
+            }
+
+            ASSERT_TRUE_MSG(sparse * other == dense * other, "SparseMatrix SpMM")
+            ASSERT_TRUE_MSG(other.transposed() * sparse.transposed() == other.transposed() * dense.transposed(),
+                            "Matrix * SparseMatrix")
+            ASSERT_TRUE_MSG((sparse + sparse * 2.).toDense() == dense * 3., "SparseMatrix operator +")
+            ASSERT_TRUE_MSG((sparse - sparse).toDense() == dense * 0., "SparseMatrix operator -")
+        }
+        ASSERT_EXCEPTION_MSG(csr * Matrix(size, 2), task::SizeMismatchException, "SparseMatrix SpMM")
+    }
+
+
+    {
+        auto mat1 = RandomMatrix(37, 21);
+        std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+        task::writeBinary(stream, mat1);
+        std::string data = stream.str();
+        ASSERT_TRUE_MSG(task::readBinary(stream) == mat1, "writeBinary() / readBinary()")
+
+        UnseekableBuffer buffer(data);
+        std::istream pipe(&buffer);
+        ASSERT_TRUE_MSG(task::readBinary(pipe) == mat1, "readBinary() without seeking")
+
+        std::stringstream transposed(std::ios::in | std::ios::out | std::ios::binary);
+        task::writeBinary(transposed, mat1.transposedView());
+        ASSERT_TRUE_MSG(task::readBinary(transposed) == mat1.transposed(), "writeBinary() of a view")
+
+        const std::string path = "test_matrix.bin";
+        task::saveBinary(path, mat1);
+        ASSERT_TRUE_MSG(task::loadBinary(path) == mat1, "saveBinary() / loadBinary()")
+        {
+            task::MappedMatrix mapped(path);
+            ASSERT_TRUE_MSG(mapped.getNumRows() == 37 && mapped.getNumCols() == 21, "MappedMatrix")
+            ASSERT_TRUE_MSG(mapped.view() == mat1, "MappedMatrix::view()")
+        }
+
+        // A header claiming far more values than follow must throw before allocating them.
+        task::MatrixFileHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        header.rows = header.cols = 1 << 28;
+        std::string forged(reinterpret_cast<const char*>(&header), sizeof(header));
+        forged += data.substr(sizeof(header));
+        std::stringstream huge(forged, std::ios::in | std::ios::binary);
+        ASSERT_EXCEPTION_MSG(task::readBinary(huge), task::MatrixFormatException, "readBinary() size check")
+        UnseekableBuffer huge_buffer(forged);
+        std::istream huge_pipe(&huge_buffer);
+        ASSERT_EXCEPTION_MSG(task::readBinary(huge_pipe), task::MatrixFormatException, "readBinary() size check")
+
+        std::stringstream truncated(data.substr(0, data.size() - 8), std::ios::in | std::ios::binary);
+        ASSERT_EXCEPTION_MSG(task::readBinary(truncated), task::MatrixFormatException, "readBinary() truncated")
+        std::stringstream bad_magic("XMAT" + data.substr(4), std::ios::in | std::ios::binary);
+        ASSERT_EXCEPTION_MSG(task::readBinary(bad_magic), task::MatrixFormatException, "readBinary() magic")
+
+        {
+            std::ofstream output(path, std::ios::binary | std::ios::trunc);
+            output << forged;
+        }
+        ASSERT_EXCEPTION_MSG(task::MappedMatrix{path}, task::MatrixFormatException, "MappedMatrix size check")
+        ASSERT_EXCEPTION_MSG(task::loadBinary(path), task::MatrixFormatException, "loadBinary() size check")
+        std::remove(path.c_str());
+        ASSERT_EXCEPTION_MSG(task::loadBinary(path), task::MatrixIOException, "loadBinary() missing file")
+    }
+
+
+    {
+        auto mat1 = RandomMatrix(30, 17);
+        mat1[0][0] = 1e-300;
+        mat1[0][1] = -1.7976931348623157e308;
+        mat1[0][2] = 0.1;
+
+        std::stringstream stream;
+        stream.precision(17);
+        stream << "30 17\n" << mat1;
+        Matrix mat2;
+        stream >> mat2;
+        for (size_t row = 0; row < 30; ++row)
+            for (size_t col = 0; col < 17; ++col)
+                ASSERT_TRUE_MSG(mat2[row][col] == mat1[row][col], "Exact stream round-trip")
+
+        std::stringstream text;
+        task::writeText(text, mat1);
+        std::string data = text.str();
+        Matrix mat3;
+        const char* end = task::parseText(data.data(), data.data() + data.size(), mat3);
+        ASSERT_TRUE_MSG(std::string(end) == "\n", "parseText()")
+        for (size_t row = 0; row < 30; ++row)
+            for (size_t col = 0; col < 17; ++col)
+                ASSERT_TRUE_MSG(mat3[row][col] == mat1[row][col], "Exact writeText() / parseText() round-trip")
+
+        // Stream extraction accepts a leading '+' and numbers of any length.
+        std::string digits = "0." + std::string(100, '0') + "25";
+        std::stringstream accepted("1 3\n+1.5 " + digits + " -2e3");
+        accepted >> mat2;
+        ASSERT_TRUE_MSG(accepted && mat2.getNumRows() == 1 && mat2.getNumCols() == 3, "Stream input operator")
+        ASSERT_TRUE_MSG(mat2[0][0] == 1.5 && mat2[0][1] == 25e-102 && mat2[0][2] == -2000., "Stream input operator")
+
+        for (const char* malformed : {"1 2\n1.5 2x", "1 2\nabc 1", "1 2\n--1 2", "1 2\n1", "x 2\n1 2"}) {
+            std::stringstream bad(malformed);
+            bad >> mat2;
+            ASSERT_TRUE_MSG(bad.fail(), "Stream input operator on malformed input")
+            ASSERT_EXCEPTION_MSG(task::parseText(malformed, malformed + strlen(malformed), mat3),
+                                 task::MatrixFormatException, "parseText() on malformed input")
+        }
+
+        task::BasicMatrix<int> ints;
+        std::stringstream int_text("2 2\n1 -2 +3 4");
+        int_text >> ints;
+        ASSERT_TRUE_MSG(int_text && ints[0][1] == -2 && ints[1][0] == 3, "Stream input of an int matrix")
+        std::stringstream int_output;
+        int_output << ints;
+        ASSERT_TRUE_MSG(int_output.str() == "1 -2 \n3 4 \n", "Stream output of an int matrix")
+        std::stringstream fraction("1 1\n1.5");
+        fraction >> ints;
+        ASSERT_TRUE_MSG(fraction.fail(), "Stream input of an int matrix")
+    }
+
+
+    {
+        auto dense = RandomMatrix(3, 3);
+        task::FixedMatrix<3, 3> fixed(dense);
+        ASSERT_TRUE_MSG(Matrix(fixed) == dense, "FixedMatrix conversions")
+        ASSERT_TRUE_MSG(Matrix(fixed * fixed) == dense * dense, "FixedMatrix operator *")
+        ASSERT_TRUE_MSG(fabs(fixed.det() - dense.det()) < EPS * 10., "FixedMatrix::det()")
+
+        // == allows the same per-element difference as Matrix: exactly EPS still compares equal.
+        Matrix zero = dense * 0., shifted = zero;
+        shifted[1][2] = EPS;
+        task::FixedMatrix<3, 3> fixed_zero(zero), fixed_shifted(shifted);
+        ASSERT_TRUE_MSG((zero == shifted) == (fixed_zero == fixed_shifted), "FixedMatrix operator ==")
+        shifted[1][2] = 2 * EPS;
+        fixed_shifted = task::FixedMatrix<3, 3>(shifted);
+        ASSERT_TRUE_MSG(zero != shifted && fixed_zero != fixed_shifted, "FixedMatrix operator !=")
+        ASSERT_EXCEPTION_MSG((task::FixedMatrix<2, 3>(dense)), task::SizeMismatchException, "FixedMatrix(Matrix)")
+
+        // 4 x 4 takes the adjugate closed form, 5 x 5 Gauss-Jordan elimination.
+        auto check_inverse = [](auto fixed, const Matrix& dense) {
+            ASSERT_TRUE_MSG(fabs(fixed.det() - dense.det()) < EPS * std::max(1., fabs(dense.det())),
+                            "FixedMatrix::det() against Matrix::det()")
+            ASSERT_TRUE_MSG(fixed * fixed.inverse() == decltype(fixed)(), "FixedMatrix::inverse()")
+            ASSERT_TRUE_MSG(fixed.inverse() * fixed == decltype(fixed)(), "FixedMatrix::inverse()")
+        };
+        auto dense4 = RandomMatrix(4, 4), dense5 = RandomMatrix(5, 5);
+        check_inverse(task::FixedMatrix<4, 4>(dense4), dense4);
+        check_inverse(task::FixedMatrix<5, 5>(dense5), dense5);
+        dense4[3][0] = dense4[3][1] = dense4[3][2] = dense4[3][3] = 0.;
+        ASSERT_EXCEPTION_MSG((task::FixedMatrix<4, 4>(dense4).inverse()), task::SingularMatrixException,
+                             "FixedMatrix::inverse() of a singular matrix")
+
+        // Everything up to det() and inverse() is usable in constant expressions.
+        constexpr auto two = FixedTwoByTwo(3., 1., 4., 2.);
+        static_assert(two.det() == 2., "constexpr FixedMatrix::det()");
+        static_assert(two * two.inverse() == task::FixedMatrix<2, 2>(), "constexpr FixedMatrix::inverse()");
+    }
+
+
+    {
+        // Every kernel level must agree with the scalar loops, masked AVX-512 tails included.
+        const size_t LENGTH = 77;
+        std::vector<double> a(LENGTH), b(LENGTH);
+        for (size_t i = 0; i < LENGTH; ++i) {
+            a[i] = RandomDouble();
+            b[i] = RandomDouble();
+        }
+        auto best = task::getSimdLevel();
+        for (auto level : {task::SimdLevel::SCALAR, task::SimdLevel::SSE2, task::SimdLevel::AVX2,
+                           task::SimdLevel::AVX512}) {
+            task::setSimdLevel(level);
+            for (size_t n : {size_t(1), size_t(7), size_t(16), size_t(35), LENGTH}) {
+                auto sum = a, difference = a, scaled = a;
+                task::vectorAdd(sum.data(), b.data(), n);
+                task::vectorSub(difference.data(), b.data(), n);
+                task::vectorScale(scaled.data(), 1.5, n);
+                for (size_t i = 0; i < LENGTH; ++i) {
+                    ASSERT_TRUE_MSG(sum[i] == (i < n ? a[i] + b[i] : a[i]), "vectorAdd()")
+                    ASSERT_TRUE_MSG(difference[i] == (i < n ? a[i] - b[i] : a[i]), "vectorSub()")
+                    ASSERT_TRUE_MSG(scaled[i] == (i < n ? a[i] * 1.5 : a[i]), "vectorScale()")
+                }
+
+                auto close = a;
+                ASSERT_TRUE_MSG(task::vectorEqual(a.data(), close.data(), n, 1e-9), "vectorEqual()")
+                close[n - 1] += 1e-8;
+                ASSERT_TRUE_MSG(!task::vectorEqual(a.data(), close.data(), n, 1e-9), "vectorEqual()")
+                ASSERT_TRUE_MSG(task::vectorEqual(a.data(), close.data(), n - 1, 1e-9), "vectorEqual()")
+                close = a;
+                close[0] -= 1e-8;
+                ASSERT_TRUE_MSG(!task::vectorEqual(a.data(), close.data(), n, 1e-9), "vectorEqual()")
+            }
+        }
+        task::setSimdLevel(best);
+    }
+
+
+    {
+        // Every kernel level must agree with the scalar loops, tails included.
+        const size_t LENGTH = 77;
+        std::vector<float> a(LENGTH), b(LENGTH);
+        for (size_t i = 0; i < LENGTH; ++i) {
+            a[i] = static_cast<float>(RandomDouble());
+            b[i] = static_cast<float>(RandomDouble());
+        }
+        auto best = task::getSimdLevel();
+        for (auto level : {task::SimdLevel::SCALAR, task::SimdLevel::SSE2, task::SimdLevel::AVX2,
+                           task::SimdLevel::AVX512}) {
+            task::setSimdLevel(level);
+            for (size_t n : {size_t(1), size_t(7), size_t(16), LENGTH}) {
+                auto sum = a, difference = a, scaled = a;
+                task::vectorAdd(sum.data(), b.data(), n);
+                task::vectorSub(difference.data(), b.data(), n);
+                task::vectorScale(scaled.data(), 1.5f, n);
+                for (size_t i = 0; i < LENGTH; ++i) {
+                    ASSERT_TRUE_MSG(sum[i] == (i < n ? a[i] + b[i] : a[i]), "float vectorAdd()")
+                    ASSERT_TRUE_MSG(difference[i] == (i < n ? a[i] - b[i] : a[i]), "float vectorSub()")
+                    ASSERT_TRUE_MSG(scaled[i] == (i < n ? a[i] * 1.5f : a[i]), "float vectorScale()")
+                }
+
+                auto close = a;
+                ASSERT_TRUE_MSG(task::vectorEqual(a.data(), close.data(), n, 1e-4f), "float vectorEqual()")
+                close[n - 1] += 1e-3f;
+                ASSERT_TRUE_MSG(!task::vectorEqual(a.data(), close.data(), n, 1e-4f), "float vectorEqual()")
+                ASSERT_TRUE_MSG(task::vectorEqual(a.data(), close.data(), n - 1, 1e-4f), "float vectorEqual()")
+            }
+        }
+        task::setSimdLevel(best);
+    }
+
+
+    for (size_t size : {1, 2, 3, 5})
+    {
+        // 300 matrices span two elimination chunks for the sizes without a closed form.
+        const size_t COUNT = 300;
+        task::MatrixBatch batch(COUNT, size, size), other(COUNT, size, size);
+        std::vector<Matrix> mats, others;
+        for (size_t i = 0; i < COUNT; ++i) {
+            mats.push_back(RandomMatrix(size, size));
+            others.push_back(RandomMatrix(size, size));
+            batch.setMatrix(i, mats[i]);
+            other.setMatrix(i, others[i]);
+        }
+        ASSERT_TRUE_MSG(batch.getMatrix(17) == mats[17], "MatrixBatch::setMatrix() / getMatrix()")
+
+        auto dets = batch.det();
+        auto traces = batch.trace();
+        auto inverses = batch.inverse();
+        auto products = batch * other;
+        for (size_t i = 0; i < COUNT; ++i) {
+            double det = mats[i].det();
+            ASSERT_TRUE_MSG(fabs(dets[i] - det) < EPS * std::max(1., fabs(det)), "MatrixBatch::det()")
+            ASSERT_TRUE_MSG(fabs(traces[i] - mats[i].trace()) < EPS, "MatrixBatch::trace()")
+            ASSERT_TRUE_MSG(products.getMatrix(i) == mats[i] * others[i], "MatrixBatch operator *")
+            if (fabs(det) > 0.1)
+                ASSERT_TRUE_MSG(inverses.getMatrix(i) * mats[i] == Matrix(size, size), "MatrixBatch::inverse()")
+        }
+
+        // Equal integer rows cancel exactly, so the member is singular for both code paths.
+        Matrix singular(size, size);
+        for (size_t col = 0; col < size; ++col)
+            singular[0][col] = singular[size - 1][col] = static_cast<double>(RandomUInt(1, 9));
+        if (size == 1)
+            singular[0][0] = 0.;
+        batch.setMatrix(COUNT - 1, singular);
+        ASSERT_TRUE_MSG(batch.det()[COUNT - 1] == 0., "MatrixBatch::det() of a singular matrix")
+        ASSERT_EXCEPTION_MSG(batch.inverse(), task::SingularMatrixException, "MatrixBatch::inverse()")
+        ASSERT_EXCEPTION_MSG(batch * task::MatrixBatch(COUNT - 1, size, size), task::SizeMismatchException,
+                             "MatrixBatch operator *")
+    }
+
+
+    for (size_t size : {1, 5, 100})
+    {
+        // 100 spans more than one LU_BLOCK / CHOLESKY_BLOCK panel.
+        auto mat1 = RandomMatrix(size, size);
+        auto rhs = RandomMatrix(size, 3);
+        std::vector<double> b(size);
+        for (double& value : b)
+            value = RandomDouble();
+        Matrix identity(size, size);
+
+        task::LUDecomposition lu(mat1);
+        ASSERT_TRUE_MSG(!lu.isSingular(), "LUDecomposition::isSingular()")
+        ASSERT_TRUE_MSG(fabs(lu.det() - mat1.det()) < EPS * std::max(1., fabs(mat1.det())), "LUDecomposition::det()")
+        ASSERT_TRUE_MSG(mat1 * lu.solve(rhs) == rhs, "LUDecomposition::solve()")
+        auto x = lu.solve(b);
+        auto residual = mat1 * x;
+        for (size_t i = 0; i < size; ++i)
+            ASSERT_TRUE_MSG(fabs(residual[i] - b[i]) < EPS, "LUDecomposition::solve() of a vector")
+        ASSERT_TRUE_MSG(mat1 * task::inverse(mat1) == identity, "inverse()")
+
+        // A A^T + I is symmetric positive definite.
+        auto spd = mat1 * mat1.transposed() + identity;
+        task::CholeskyDecomposition cholesky(spd);
+        auto l = cholesky.getL();
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = i + 1; j < size; ++j)
+                ASSERT_TRUE_MSG(l[i][j] == 0., "CholeskyDecomposition::getL() is lower triangular")
+        ASSERT_TRUE_MSG(l * l.transposed() == spd, "CholeskyDecomposition::getL()")
+        ASSERT_TRUE_MSG(spd * cholesky.solve(rhs) == rhs, "CholeskyDecomposition::solve()")
+        ASSERT_TRUE_MSG(spd * cholesky.inverse() == identity, "CholeskyDecomposition::inverse()")
+        // Beyond a few dozen rows the determinant of A A^T + I overflows a double.
+        if (std::isfinite(spd.det()))
+            ASSERT_TRUE_MSG(fabs(cholesky.det() - spd.det()) < EPS * std::max(1., fabs(spd.det())),
+                            "CholeskyDecomposition::det()")
+        ASSERT_EXCEPTION_MSG(task::CholeskyDecomposition(-spd), task::NotPositiveDefiniteException,
+                             "CholeskyDecomposition of a matrix that is not positive definite")
+
+        auto tall = RandomMatrix(size + 7, size);
+        auto tall_rhs = RandomMatrix(size + 7, 2);
+        task::QRDecomposition qr(tall);
+        auto q = qr.getQ(), r = qr.getR();
+        ASSERT_TRUE_MSG(qr.isFullRank(), "QRDecomposition::isFullRank()")
+        ASSERT_TRUE_MSG(q.transposed() * q == identity, "QRDecomposition::getQ() is orthonormal")
+        ASSERT_TRUE_MSG(q * r == tall, "QRDecomposition::getQ() * getR()")
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = 0; j < i; ++j)
+                ASSERT_TRUE_MSG(r[i][j] == 0., "QRDecomposition::getR() is upper triangular")
+        // The least-squares residual is orthogonal to the columns of A.
+        auto normal = tall.transposed() * (tall * qr.solve(tall_rhs) - tall_rhs);
+        ASSERT_TRUE_MSG(normal == normal * 0., "QRDecomposition::solve() least squares")
+        ASSERT_TRUE_MSG(mat1 * task::QRDecomposition(mat1).inverse() == identity, "QRDecomposition::inverse()")
+
+        {
+            // Elimination keeps a zero column exactly zero, so the last pivot is exactly 0.
+            auto singular = mat1;
+            for (size_t row = 0; row < size; ++row)
+                singular[row][size - 1] = 0.;
+            ASSERT_TRUE_MSG(task::LUDecomposition(singular).isSingular(), "LUDecomposition::isSingular()")
+            ASSERT_EXCEPTION_MSG(task::LUDecomposition(singular).solve(b), task::SingularMatrixException,
+                                 "LUDecomposition::solve() of a singular matrix")
+            ASSERT_EXCEPTION_MSG(task::inverse(singular), task::SingularMatrixException, "inverse() of a singular matrix")
+        }
+        ASSERT_EXCEPTION_MSG(task::LUDecomposition(RandomMatrix(size, size + 1)), task::SizeMismatchException,
+                             "LUDecomposition of a non-square matrix")
+    }
+
+
+    {
+        const size_t LENGTH = 83;
+        std::vector<double> a(LENGTH), b(LENGTH);
+        for (size_t i = 0; i < LENGTH; ++i) {
+            a[i] = RandomDouble();
+            b[i] = RandomDouble();
+        }
+        auto best = task::getSimdLevel();
+        for (size_t n : {size_t(3), size_t(16), LENGTH}) {
+            task::setSimdLevel(task::SimdLevel::SCALAR);
+            auto expected_axpy = a;
+            task::vectorAxpy(expected_axpy.data(), 0.3, b.data(), n);
+            double expected_dot = task::vectorDot(a.data(), b.data(), n);
+            for (auto level : {task::SimdLevel::SSE2, task::SimdLevel::AVX2, task::SimdLevel::AVX512}) {
+                task::setSimdLevel(level);
+                auto axpy = a;
+                task::vectorAxpy(axpy.data(), 0.3, b.data(), n);
+                ASSERT_TRUE_MSG(axpy == expected_axpy, "vectorAxpy() agrees at every SimdLevel")
+                ASSERT_TRUE_MSG(fabs(task::vectorDot(a.data(), b.data(), n) - expected_dot) < EPS, "vectorDot()")
+            }
+        }
+        task::setSimdLevel(best);
+
+        auto mat1 = RandomMatrix(40, LENGTH);
+        auto y = mat1 * b;
+        auto z = a * mat1.transposed();
+        for (size_t row = 0; row < 40; ++row) {
+            double dot = 0.;
+            for (size_t col = 0; col < LENGTH; ++col)
+                dot += mat1[row][col] * b[col];
+            ASSERT_TRUE_MSG(fabs(y[row] - dot) < EPS, "Matrix * vector")
+        }
+        ASSERT_TRUE_MSG(z.size() == 40, "vector * Matrix")
+        for (size_t row = 0; row < 40; ++row) {
+            double dot = 0.;
+            for (size_t col = 0; col < LENGTH; ++col)
+                dot += mat1[row][col] * a[col];
+            ASSERT_TRUE_MSG(fabs(z[row] - dot) < EPS, "vector * Matrix")
+        }
+        auto updated = mat1;
+        task::rankOneUpdate(updated, 2., y, b);
+        for (size_t row = 0; row < 40; ++row)
+            for (size_t col = 0; col < LENGTH; ++col)
+                ASSERT_TRUE_MSG(fabs(updated[row][col] - mat1[row][col] - 2. * y[row] * b[col]) < EPS, "rankOneUpdate()")
+    }
+
+
+    {
+        // 10x100 * 100x5 * 5x50 * 50x3 is cheapest right to left: 5250 multiply-adds instead of 9000.
+        auto mat1 = RandomMatrix(10, 100), mat2 = RandomMatrix(100, 5), mat3 = RandomMatrix(5, 50);
+        auto mat4 = RandomMatrix(50, 3);
+        auto chain = task::MatrixChain(mat1) * mat2 * mat3 * mat4;
+        auto plan = chain.plan();
+        ASSERT_TRUE_MSG(chain.size() == 4 && chain.getNumRows() == 10 && chain.getNumCols() == 3, "MatrixChain shape")
+        ASSERT_TRUE_MSG(plan.toString() == "(A0 (A1 (A2 A3)))", "MatrixChain::plan()")
+        ASSERT_TRUE_MSG(plan.cost == 5250 && plan.left_to_right_cost == 9000, "MatrixChain::plan() costs")
+        ASSERT_TRUE_MSG(chain.evaluate() == mat1 * mat2 * mat3 * mat4, "MatrixChain::evaluate()")
+
+        // Views are read through their strides, transposed ones included.
+        auto mat5 = RandomMatrix(7, 50);
+        task::MatrixChain viewed(mat3.block(1, 0, 4, 50));
+        viewed *= mat5.transposedView();
+        viewed *= mat1.block(0, 3, 7, 60);
+        ASSERT_TRUE_MSG(viewed.evaluate() == mat3.block(1, 0, 4, 50) * mat5.transposed() * mat1.block(0, 3, 7, 60),
+                        "MatrixChain::evaluate() of views")
+
+        task::MatrixChain single(mat2);
+        ASSERT_TRUE_MSG(single.plan().toString() == "A0" && single.plan().cost == 0,
+                        "MatrixChain::plan() of one operand")
+        ASSERT_TRUE_MSG(single.evaluate() == mat2, "MatrixChain::evaluate() of one operand")
+        ASSERT_EXCEPTION_MSG(single *= mat4, task::SizeMismatchException, "MatrixChain operator *=")
+        ASSERT_TRUE_MSG(single.size() == 1, "MatrixChain operator *= leaves the chain alone when it throws")
+    }
+
+
+    {
+        // Copies share the buffer of a heap-allocated matrix until one of them is written to.
+        const auto orig = RandomMatrix(10, 12);
+        auto source = orig;
+        ASSERT_TRUE_MSG(source.view().data() == orig.view().data(), "Copies share storage")
+
+        auto copy = source;
+        copy.get(1, 2) = 5.;
+        ASSERT_TRUE_MSG(source == orig && copy.get(1, 2) == 5., "get() detaches a copy")
+        copy = source;
+        copy.set(1, 2, 5.);
+        ASSERT_TRUE_MSG(source == orig && copy.get(1, 2) == 5., "set() detaches a copy")
+        copy = source;
+        copy[3][4] = 5.;
+        ASSERT_TRUE_MSG(source == orig && copy[3][4] == 5., "Operator [] detaches a copy")
+        copy = source;
+        copy += orig;
+        ASSERT_TRUE_MSG(source == orig && copy == orig * 2., "Operator += detaches a copy")
+        copy = source;
+        copy -= orig;
+        ASSERT_TRUE_MSG(source == orig && copy == orig * 0., "Operator -= detaches a copy")
+        copy = source;
+        copy *= 3.;
+        ASSERT_TRUE_MSG(source == orig && copy == orig * 3., "Operator *= detaches a copy")
+        copy = source;
+        copy.transpose();
+        ASSERT_TRUE_MSG(source == orig && copy == orig.transposed(), "transpose() detaches a copy")
+        copy = source;
+        copy.resize(10, 11);
+        ASSERT_TRUE_MSG(source == orig && copy == orig.block(0, 0, 10, 11), "resize() detaches a copy")
+        copy = source;
+        copy = copy.transposedView() * 2.;
+        ASSERT_TRUE_MSG(source == orig && copy == orig.transposed() * 2., "Assignment detaches a copy")
+
+        // Writing to the original leaves its copies alone too.
+        copy = source;
+        source[0][0] += 1.;
+        ASSERT_TRUE_MSG(copy == orig && source[0][0] == orig[0][0] + 1., "Writes to the original detach it")
+        ASSERT_TRUE_MSG(copy.view().data() != source.view().data(), "Writes to the original detach it")
+    }
+
+
+    {
+        // resize keeps the overlapping elements and zeroes the rest, in place while capacity() allows.
+        auto orig = RandomMatrix(40, 30);
+        auto mat1 = orig;
+        mat1.resize(20, 35);
+        ASSERT_TRUE_MSG(IsResized(mat1, orig), "resize() of a shared matrix")
+        ASSERT_TRUE_MSG(orig.getNumRows() == 40 && mat1.capacity() >= 20 * 35, "resize() of a shared matrix")
+
+        mat1 = RandomMatrix(40, 30);
+        size_t capacity = mat1.capacity();
+        const double* data = mat1.view().data();
+        for (auto shape : {std::make_pair(20, 30), std::make_pair(30, 12), std::make_pair(25, 40)}) {
+            auto before = Matrix(mat1.view());
+            mat1.resize(shape.first, shape.second);
+            ASSERT_TRUE_MSG(IsResized(mat1, before), "resize() within capacity()")
+            ASSERT_TRUE_MSG(mat1.capacity() == capacity && mat1.view().data() == data, "resize() within capacity()")
+        }
+
+        mat1.reserve(capacity * 4);
+        ASSERT_TRUE_MSG(mat1.capacity() >= capacity * 4, "reserve()")
+        data = mat1.view().data();
+        auto before = Matrix(mat1.view());
+        mat1.resize(60, 60);
+        ASSERT_TRUE_MSG(IsResized(mat1, before) && mat1.view().data() == data, "resize() after reserve()")
+        mat1.resize(10, 10);
+        before = Matrix(mat1.view());
+        mat1.shrinkToFit();
+        ASSERT_TRUE_MSG(mat1 == before && mat1.capacity() < capacity, "shrinkToFit()")
+        mat1.resize(12, 9);
+        ASSERT_TRUE_MSG(IsResized(mat1, before), "resize() after shrinkToFit()")
+
+        // Buffers released under a pool are handed out again to the next matrices of the thread.
+        {
+            task::MatrixBufferPool pool;
+            task::setThreadBufferPool(&pool);
+            {
+                auto pooled = RandomMatrix(64, 64);
+                ASSERT_TRUE_MSG(pooled * Matrix(64, 64) == pooled, "Matrices from a MatrixBufferPool")
+            }
+            ASSERT_TRUE_MSG(pool.getCachedBytes() > 0, "MatrixBufferPool::release()")
+            size_t cached = pool.getCachedBytes();
+            {
+                auto pooled = RandomMatrix(64, 64);
+                ASSERT_TRUE_MSG(pool.getCachedBytes() < cached, "MatrixBufferPool::acquire()")
+            }
+            task::setThreadBufferPool(nullptr);
+        }
+    }
+
+
+    {
+        // Shapes of at most MATRIX_INLINE_ELEMENTS elements live inside the object, larger ones on the heap.
+        const size_t INLINE = task::MATRIX_INLINE_ELEMENTS;
+        auto small = RandomMatrix(2, 2);
+        auto big = RandomMatrix(8, 8);
+        ASSERT_TRUE_MSG(small.capacity() == (INLINE >= 4 ? INLINE : 4), "capacity() of an inline matrix")
+
+        auto mat1 = small;
+        mat1.resize(8, 8);
+        ASSERT_TRUE_MSG(IsResized(mat1, small) && mat1.capacity() >= 64, "resize() from inline to heap storage")
+        mat1.resize(2, 3);
+        ASSERT_TRUE_MSG(IsResized(mat1, small) && mat1.capacity() >= 64, "resize() keeps heap storage")
+        mat1.shrinkToFit();
+        ASSERT_TRUE_MSG(IsResized(mat1, small), "shrinkToFit() back to inline storage")
+        ASSERT_TRUE_MSG(mat1.capacity() == (INLINE >= 6 ? INLINE : 6), "shrinkToFit() back to inline storage")
+
+        mat1 = big;
+        mat1.resize(2, 2);
+        ASSERT_TRUE_MSG(mat1 == big.block(0, 0, 2, 2), "resize() from heap to a small shape")
+        ASSERT_TRUE_MSG(mat1.capacity() == (INLINE >= 4 ? INLINE : 4), "resize() of a shared matrix to a small shape")
+
+        mat1 = small;
+        mat1.resize(3, 3);
+        ASSERT_TRUE_MSG(IsResized(mat1, small), "resize() within inline storage")
+        mat1 = small;
+        mat1.reserve(100);
+        ASSERT_TRUE_MSG(mat1 == small && mat1.capacity() >= 100, "reserve() from inline storage")
+
+        // Moving inline storage copies the elements; the source is left empty either way.
+        auto moved = small;
+        auto target = std::move(moved);
+        ASSERT_TRUE_MSG(target == small && moved.getNumRows() == 0, "Move constructor of an inline matrix")
+        moved = big;
+        moved = std::move(target);
+        ASSERT_TRUE_MSG(moved == small && target.getNumRows() == 0, "Move of an inline matrix over a heap one")
+        target = std::move(moved);
+        moved = big;
+        target = std::move(moved);
+        ASSERT_TRUE_MSG(target == big && moved.getNumRows() == 0, "Move of a heap matrix over an inline one")
+        moved = small;
+        std::swap(moved, target);
+        ASSERT_TRUE_MSG(moved == big && target == small, "std::swap of inline and heap matrices")
+
+        auto copy = small;
+        copy[0][0] += 1.;
+        ASSERT_TRUE_MSG(copy[0][0] == small[0][0] + 1. && copy[1][1] == small[1][1], "Copy of an inline matrix")
+    }
+
+
+    for (size_t size : {1, 6, 150})
+    {
+        // 150 rows span two STRUCTURED_BLOCK panels in the products with a Matrix.
+        auto random = RandomMatrix(size, size);
+        auto other = RandomMatrix(size, size);
+        auto rhs = RandomMatrix(size, 4);
+        std::vector<double> x(size);
+        Matrix x_column(size, 1);
+        for (size_t row = 0; row < size; ++row) {
+            x[row] = RandomDouble();
+            x_column[row][0] = x[row];
+        }
+        auto det_close = [](double value, double expected) {
+            return fabs(value - expected) <= 1e-9 * std::max(1., fabs(expected)) ||
+                   (std::isinf(value) && value == expected);
+        };
+
+        Matrix symmetric = random + random.transposed();
+        task::SymmetricMatrix packed(symmetric);
+        ASSERT_TRUE_MSG(packed.toDense() == symmetric, "SymmetricMatrix::toDense()")
+        ASSERT_TRUE_MSG(IsColumn(packed * x, symmetric * x_column), "SymmetricMatrix * vector")
+        ASSERT_TRUE_MSG(packed * rhs == symmetric * rhs, "SymmetricMatrix * Matrix")
+        ASSERT_TRUE_MSG(rhs.transposed() * packed == rhs.transposed() * symmetric, "Matrix * SymmetricMatrix")
+        ASSERT_TRUE_MSG(det_close(packed.det(), symmetric.det()), "SymmetricMatrix::det() of an indefinite matrix")
+        Matrix spd = random * random.transposed() + Matrix(size, size);
+        ASSERT_TRUE_MSG(det_close(task::SymmetricMatrix(spd).det(), spd.det()),
+                        "SymmetricMatrix::det() of a positive definite matrix")
+
+        for (auto triangle : {task::TriangularMatrix::Triangle::Lower, task::TriangularMatrix::Triangle::Upper}) {
+            bool lower = triangle == task::TriangularMatrix::Triangle::Lower;
+            auto triangular = [&](const Matrix& dense) {
+                Matrix result = dense;
+                for (size_t row = 0; row < size; ++row)
+                    for (size_t col = 0; col < size; ++col)
+                        if (lower ? col > row : col < row)
+                            result[row][col] = 0.;
+                return result;
+            };
+            Matrix dense = triangular(random), dense_other = triangular(other);
+            task::TriangularMatrix packed_tri(random, triangle), packed_other(other, triangle);
+            ASSERT_TRUE_MSG(packed_tri.toDense() == dense, "TriangularMatrix::toDense()")
+            ASSERT_TRUE_MSG(packed_tri.transposed().toDense() == dense.transposed(), "TriangularMatrix::transposed()")
+            ASSERT_TRUE_MSG(IsColumn(packed_tri * x, dense * x_column), "TriangularMatrix * vector")
+            ASSERT_TRUE_MSG(packed_tri * rhs == dense * rhs, "TriangularMatrix * Matrix")
+            ASSERT_TRUE_MSG(rhs.transposed() * packed_tri == rhs.transposed() * dense, "Matrix * TriangularMatrix")
+            ASSERT_TRUE_MSG((packed_tri * packed_other).toDense() == dense * dense_other,
+                            "TriangularMatrix * TriangularMatrix")
+            // Pivoting on a large random lower triangle loses every digit; its transpose needs no pivots.
+            ASSERT_TRUE_MSG(det_close(packed_tri.det(), (lower ? dense.transposed() : dense).det()),
+                            "TriangularMatrix::det()")
+        }
+        ASSERT_EXCEPTION_MSG(task::TriangularMatrix(random) + task::TriangularMatrix(random).transposed(),
+                             task::SizeMismatchException, "TriangularMatrix of different triangles")
+
+        Matrix diagonal = Matrix(size, size) * 0., diagonal_other = diagonal;
+        for (size_t i = 0; i < size; ++i) {
+            diagonal[i][i] = random[i][i];
+            diagonal_other[i][i] = other[i][i];
+        }
+        task::DiagonalMatrix packed_diag(random), packed_diag_other(other);
+        ASSERT_TRUE_MSG(packed_diag.toDense() == diagonal, "DiagonalMatrix::toDense()")
+        ASSERT_TRUE_MSG(IsColumn(packed_diag * x, diagonal * x_column), "DiagonalMatrix * vector")
+        ASSERT_TRUE_MSG(packed_diag * rhs == diagonal * rhs, "DiagonalMatrix * Matrix")
+        ASSERT_TRUE_MSG(rhs.transposed() * packed_diag == rhs.transposed() * diagonal, "Matrix * DiagonalMatrix")
+        ASSERT_TRUE_MSG((packed_diag * packed_diag_other).toDense() == diagonal * diagonal_other,
+                        "DiagonalMatrix * DiagonalMatrix")
+        ASSERT_TRUE_MSG(det_close(packed_diag.det(), diagonal.det()), "DiagonalMatrix::det()")
+
+        for (size_t bandwidth : {0, 1, 3}) {
+            auto banded = [&](const Matrix& dense, size_t width) {
+                Matrix result = dense;
+                for (size_t row = 0; row < size; ++row)
+                    for (size_t col = 0; col < size; ++col)
+                        if (row > col + width || col > row + width)
+                            result[row][col] = 0.;
+                return result;
+            };
+            Matrix dense = banded(random, bandwidth), dense_other = banded(other, 2);
+            task::BandMatrix band(random, bandwidth), band_other(other, 2);
+            ASSERT_TRUE_MSG(band.toDense() == dense, "BandMatrix::toDense()")
+            ASSERT_TRUE_MSG(band.transposed().toDense() == dense.transposed(), "BandMatrix::transposed()")
+            ASSERT_TRUE_MSG(IsColumn(band * x, dense * x_column), "BandMatrix * vector")
+            ASSERT_TRUE_MSG(band * rhs == dense * rhs, "BandMatrix * Matrix")
+            ASSERT_TRUE_MSG(rhs.transposed() * band == rhs.transposed() * dense, "Matrix * BandMatrix")
+            ASSERT_TRUE_MSG((band * band_other).toDense() == dense * dense_other, "BandMatrix * BandMatrix")
+            ASSERT_TRUE_MSG((band + band_other).toDense() == dense + dense_other, "BandMatrix operator +")
+            ASSERT_TRUE_MSG(det_close(band.det(), dense.det()), "BandMatrix::det()")
+        }
+    }
+
+
+    for (size_t size : {1, 4, 70})
+    {
+        // Scaled down so the powers stay of order one; at 70 rows every product takes the packed gemm path.
+        auto mat1 = RandomMatrix(size, size);
+        mat1 *= 0.1 / size;
+        ASSERT_TRUE_MSG(mat1.pow(0) == Matrix(size, size), "pow(0) is the identity")
+        ASSERT_TRUE_MSG(mat1.pow(1) == mat1, "pow(1)")
+        Matrix expected = mat1;
+        for (uint64_t k = 2; k <= 13; ++k) {
+            expected *= mat1;
+            if (k == 2 || k == 7 || k == 8 || k == 13)
+                ASSERT_TRUE_MSG(mat1.pow(k) == expected, "pow() against repeated operator *")
+        }
+
+        // A diagonal matrix takes the element-wise path and stays diagonal.
+        Matrix diagonal(size, size);
+        for (size_t i = 0; i < size; ++i)
+            diagonal[i][i] = RandomDouble() / 5.;
+        auto diagonal_power = diagonal.pow(5);
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = 0; j < size; ++j)
+                ASSERT_TRUE_MSG(fabs(diagonal_power[i][j] - (i == j ? std::pow(diagonal[i][i], 5) : 0.)) < EPS,
+                                "pow() of a diagonal matrix")
+
+        // Entries in {-1, 0, 1} keep every power of an int matrix exact.
+        task::BasicMatrix<int> ints(size, size), expected_ints(size, size);
+        for (size_t row = 0; row < size; ++row)
+            for (size_t col = 0; col < size; ++col)
+                ints[row][col] = static_cast<int>(RandomUInt(2)) - 1;
+        for (int k = 0; k < 5; ++k)
+            expected_ints *= ints;
+        ASSERT_TRUE_MSG(ints.pow(5) == expected_ints, "pow() of an int matrix")
+
+        ASSERT_EXCEPTION_MSG(RandomMatrix(size, size + 1).pow(2), task::SizeMismatchException,
+                             "pow() of a non-square matrix")
+        ASSERT_EXCEPTION_MSG(RandomMatrix(size + 1, size).pow(0), task::SizeMismatchException,
+                             "pow(0) of a non-square matrix")
+    }
+
     const int STRESS_TEST_COUNT = argc > 1 ? std::stoi(argv[1]) : 0;
 
     REPEAT(STRESS_TEST_COUNT)